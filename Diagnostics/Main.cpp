@@ -0,0 +1,71 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+
+    Console runner for the diagnostic harnesses, for CI jobs and local runs.
+    Builds the plugin sources with BasicComp_Diagnostics=1 and runs one
+    harness per command; the exit code is non-zero when its check fails.
+
+        BasicCompDiagnostics stress
+        BasicCompDiagnostics startup
+        BasicCompDiagnostics verify [programme files...]
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include <iostream>
+#include "../Source/StressHarness.h"
+#include "../Source/StartupBenchmark.h"
+#include "../Source/ReferenceVerifier.h"
+
+namespace
+{
+    void printAndCheck(const juce::String& report, bool passed)
+    {
+        std::cout << report << std::endl;
+
+        if (!passed)
+            juce::ConsoleApplication::fail("FAILED");
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    // The harnesses build editors, so this thread becomes the message thread.
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::ConsoleApplication app;
+    app.addHelpCommand("--help|-h", "Usage:", true);
+
+    app.addCommand({ "stress", "stress",
+                     "Worst-case processBlock timing under parameter, state and editor churn.", {},
+                     [](const juce::ArgumentList&)
+                     {
+                         const auto report = CallbackStressHarness::run({});
+                         printAndCheck(report.toString(), report.passed);
+                     } });
+
+    app.addCommand({ "startup", "startup",
+                     "Per-instance construction, prepare, state load and editor times for up to 1000 instances.", {},
+                     [](const juce::ArgumentList&)
+                     {
+                         std::cout << StartupBenchmark::toString(StartupBenchmark::run({})) << std::endl;
+                     } });
+
+    app.addCommand({ "verify", "verify [programme files...]",
+                     "Optimised DSP paths against the reference chain, over the test corpus plus any audio files given.", {},
+                     [](const juce::ArgumentList& args)
+                     {
+                         ReferenceVerifier::Options options;
+
+                         for (int i = 1; i < args.size(); ++i)
+                             options.programmeFiles.add(args[i].resolveAsExistingFile());
+
+                         const auto report = ReferenceVerifier::run(options);
+                         printAndCheck(report.toString(), report.passed);
+                     } });
+
+    return app.findAndRunCommand(argc, argv);
+}
@@ -0,0 +1,32 @@
+/*
+  ==============================================================================
+
+    BackgroundThread.h
+
+    One low priority TimeSliceThread shared by every plugin instance in the
+    process (via juce::SharedResourcePointer), for analysis work that must
+    stay off the audio thread without costing each instance its own thread.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class BackgroundThread : public juce::TimeSliceThread
+{
+public:
+    BackgroundThread() : juce::TimeSliceThread("BasicComp background")
+    {
+        startThread();
+    }
+
+    ~BackgroundThread() override
+    {
+        stopThread(2000);
+    }
+
+private:
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(BackgroundThread)
+};
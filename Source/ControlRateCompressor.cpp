@@ -0,0 +1,279 @@
+/*
+  ==============================================================================
+
+    ControlRateCompressor.cpp
+
+  ==============================================================================
+*/
+
+#include "ControlRateCompressor.h"
+
+namespace
+{
+    // Peak and mean of |x| over a run, with four partial sums so the adds
+    // don't form one long dependency chain.
+    void summariseRun(const float* x, int length, float& peak, float& mean) noexcept
+    {
+        float peaks[4]{}, sums[4]{};
+        int i = 0;
+
+        for (; i + 4 <= length; i += 4)
+        {
+            for (int lane = 0; lane < 4; ++lane)
+            {
+                const auto level = std::abs(x[i + lane]);
+                peaks[lane] = juce::jmax(peaks[lane], level);
+                sums[lane] += level;
+            }
+        }
+
+        for (; i < length; ++i)
+        {
+            const auto level = std::abs(x[i]);
+            peaks[0] = juce::jmax(peaks[0], level);
+            sums[0] += level;
+        }
+
+        peak = juce::jmax(juce::jmax(peaks[0], peaks[1]), juce::jmax(peaks[2], peaks[3]));
+        mean = (sums[0] + sums[1] + sums[2] + sums[3]) / (float)length;
+    }
+}
+
+ControlRateCompressor::ControlRateCompressor()
+{
+    update();
+}
+
+void ControlRateCompressor::prepare(const juce::dsp::ProcessSpec& spec)
+{
+    jassert(spec.sampleRate > 0);
+    jassert(spec.numChannels > 0);
+
+    sampleRate = spec.sampleRate;
+    envelopes.assign(spec.numChannels, 0.0f);
+    lastGains.assign(spec.numChannels, 1.0f);
+
+    update();
+    reset();
+}
+
+void ControlRateCompressor::reset() noexcept
+{
+    std::fill(envelopes.begin(), envelopes.end(), 0.0f);
+    std::fill(lastGains.begin(), lastGains.end(), 1.0f);
+}
+
+void ControlRateCompressor::setThreshold(float newThresholdDb)
+{
+    thresholdDb = newThresholdDb;
+    update();
+}
+
+void ControlRateCompressor::setRatio(float newRatio)
+{
+    jassert(newRatio >= 1.0f);
+
+    ratio = newRatio;
+    update();
+}
+
+void ControlRateCompressor::setAttack(float newAttackMs)
+{
+    attackTime = newAttackMs;
+    update();
+}
+
+void ControlRateCompressor::setRelease(float newReleaseMs)
+{
+    releaseTime = newReleaseMs;
+    update();
+}
+
+void ControlRateCompressor::setControlInterval(int newInterval) noexcept
+{
+    controlInterval.store(juce::jlimit(1, maxControlInterval, newInterval));
+}
+
+void ControlRateCompressor::setSummaryDetector(bool shouldSummarise) noexcept
+{
+    summaryDetector.store(shouldSummarise);
+}
+
+float ControlRateCompressor::calculateCte(float timeMs) const noexcept
+{
+    // As juce::dsp::BallisticsFilter.
+    const auto expFactor = -2.0 * juce::MathConstants<double>::pi * 1000.0 / sampleRate;
+    return timeMs < 1.0e-3f ? 0.0f : (float)std::exp(expFactor / timeMs);
+}
+
+void ControlRateCompressor::update()
+{
+    threshold = juce::Decibels::decibelsToGain(thresholdDb, -200.0f);
+    thresholdInverse = 1.0f / threshold;
+    ratioInverse = 1.0f / ratio;
+    cteAttack = calculateCte(attackTime);
+    cteRelease = calculateCte(releaseTime);
+
+    runAttack[0] = runRelease[0] = 1.0f;
+
+    for (size_t length = 1; length < runAttack.size(); ++length)
+    {
+        runAttack[length] = runAttack[length - 1] * cteAttack;
+        runRelease[length] = runRelease[length - 1] * cteRelease;
+    }
+
+    releaseIntervalLimit = cteRelease <= 0.0f ? 1
+                         : juce::jlimit(1, maxControlInterval, (int)(std::log(maxReleasePerRun) / std::log(cteRelease)));
+}
+
+float ControlRateCompressor::computeGain(float envelope) const noexcept
+{
+    return envelope < threshold ? 1.0f : std::pow(envelope * thresholdInverse, ratioInverse - 1.0f);
+}
+
+float ControlRateCompressor::processSample(int channel, float inputValue) noexcept
+{
+    auto& env = envelopes[(size_t)channel];
+    const auto level = std::abs(inputValue);
+    const auto cte = level > env ? cteAttack : cteRelease;
+    env = level + cte * (env - level);
+
+    const auto gain = computeGain(env);
+    lastGains[(size_t)channel] = gain;
+    return gain * inputValue;
+}
+
+void ControlRateCompressor::processFullRate(float& env, float& gain, const float* in, float* out, int numSamples,
+                                            float* envelopeTap, float* gainTap) const noexcept
+{
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const auto x = in[i];
+        const auto level = std::abs(x);
+        const auto cte = level > env ? cteAttack : cteRelease;
+        env = level + cte * (env - level);
+
+        gain = computeGain(env);
+        out[i] = gain * x;
+
+        if (envelopeTap != nullptr)
+        {
+            envelopeTap[i] = env;
+            gainTap[i] = gain;
+        }
+    }
+}
+
+template <int NumChannels>
+void ControlRateCompressor::processDecimated(size_t firstChannel, const float* const* in, float* const* out,
+                                             int numSamples, int interval, bool summarise,
+                                             float* const* envelopeTap, float* const* gainTap) noexcept
+{
+    std::array<float, NumChannels> env, gain;
+
+    for (int c = 0; c < NumChannels; ++c)
+    {
+        env[(size_t)c] = envelopes[firstChannel + (size_t)c];
+        gain[(size_t)c] = lastGains[firstChannel + (size_t)c];
+    }
+
+    for (int start = 0; start < numSamples; start += interval)
+    {
+        const int length = juce::jmin(interval, numSamples - start);
+        const auto runStartEnv = env;
+
+        if (summarise)
+        {
+            // The detector takes one step per run, with the coefficient raised
+            // to the run's length: up towards the run's peak if that is above
+            // the envelope, otherwise down towards its mean level, which is
+            // roughly where a per-sample release would settle.
+            for (int c = 0; c < NumChannels; ++c)
+            {
+                auto& channelEnv = env[(size_t)c];
+                float peak, mean;
+                summariseRun(in[c] + start, length, peak, mean);
+
+                const auto rising = peak > channelEnv;
+                const auto level = rising ? peak : mean;
+                const auto cte = rising ? runAttack[(size_t)length] : runRelease[(size_t)length];
+                channelEnv = level + cte * (channelEnv - level);
+
+                if (envelopeTap[c] != nullptr)
+                    juce::FloatVectorOperations::fill(envelopeTap[c] + start, channelEnv, length);
+            }
+        }
+        else
+        {
+            // The detector is only a compare and a multiply-add per sample, so it
+            // keeps running at full rate. Its recurrence is latency bound, which
+            // is why the channels are interleaved here: their chains overlap.
+            for (int i = start; i < start + length; ++i)
+            {
+                for (int c = 0; c < NumChannels; ++c)
+                {
+                    const auto level = std::abs(in[c][i]);
+                    const auto cte = level > env[(size_t)c] ? cteAttack : cteRelease;
+                    env[(size_t)c] = level + cte * (env[(size_t)c] - level);
+
+                    if (envelopeTap[c] != nullptr)
+                        envelopeTap[c][i] = env[(size_t)c];
+                }
+            }
+        }
+
+        for (int c = 0; c < NumChannels; ++c)
+        {
+            auto& channelEnv = env[(size_t)c];
+            auto& channelGain = gain[(size_t)c];
+
+            // A fast attack can jump the envelope inside one run and a ramp
+            // would let that transient through, so such runs are redone at
+            // full rate.
+            if (channelEnv > runStartEnv[(size_t)c] * attackFallbackRatio && channelEnv >= threshold)
+            {
+                channelEnv = runStartEnv[(size_t)c];
+                processFullRate(channelEnv, channelGain, in[c] + start, out[c] + start, length,
+                                envelopeTap[c] != nullptr ? envelopeTap[c] + start : nullptr,
+                                gainTap[c] != nullptr ? gainTap[c] + start : nullptr);
+                continue;
+            }
+
+            // Otherwise the gain computer runs once, at the end of the run,
+            // and the applied gain is interpolated up to it.
+            const auto target = computeGain(channelEnv);
+            const auto increment = (target - channelGain) / (float)length;
+
+            if (auto* gains = gainTap[c])
+            {
+                for (int i = start; i < start + length; ++i)
+                {
+                    channelGain += increment;
+                    gains[i] = channelGain;
+                    out[c][i] = channelGain * in[c][i];
+                }
+            }
+            else
+            {
+                for (int i = start; i < start + length; ++i)
+                {
+                    channelGain += increment;
+                    out[c][i] = channelGain * in[c][i];
+                }
+            }
+
+            channelGain = target;
+        }
+    }
+
+    for (int c = 0; c < NumChannels; ++c)
+    {
+        envelopes[firstChannel + (size_t)c] = env[(size_t)c];
+        lastGains[firstChannel + (size_t)c] = gain[(size_t)c];
+    }
+}
+
+template void ControlRateCompressor::processDecimated<1>(size_t, const float* const*, float* const*, int, int, bool,
+                                                        float* const*, float* const*) noexcept;
+template void ControlRateCompressor::processDecimated<2>(size_t, const float* const*, float* const*, int, int, bool,
+                                                        float* const*, float* const*) noexcept;
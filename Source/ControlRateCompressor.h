@@ -0,0 +1,180 @@
+/*
+  ==============================================================================
+
+    ControlRateCompressor.h
+
+    Drop-in replacement for juce::dsp::Compressor<float> whose gain computer
+    can run at a decimated control rate ("eco").
+
+    With a control interval of 1 it is the same peak ballistics and hard knee
+    gain computer as juce::dsp::Compressor, sample for sample. With an
+    interval of N the envelope detector still runs on every sample, but the
+    gain computer (one std::pow) runs once per run of N samples and the
+    applied gain ramps linearly to its result. Runs in which the envelope
+    jumps by more than about 1 dB above threshold, i.e. fast attacks on
+    transients, fall back to full rate so they are not ramped through, and
+    releases fast enough to fall more than about 0.5 dB within a run shorten
+    the interval (to 2 for 5 ms at 48 kHz).
+
+    Against the full-rate path on a drum-like test signal (48 kHz, threshold
+    -24 dB, ratio 8, attack 0.1 to 10 ms, release 50 to 125 ms) the gain
+    reduction error stays below 0.7 dB at the 99.9th percentile and about
+    1 dB at worst for N = 16; with attack >= 10 ms the worst case is about
+    0.6 dB, and a 5 ms release (interval capped to 2) stays within 0.7 dB.
+    Over ReferenceVerifier's presets, signals and rates the worst case is
+    below 1.2 dB (limiter and crush on drums) and 0.1 in sample error. Stereo processing
+    time drops by about 2x at N = 4 and 2.3 to 2.8x at N = 8 to 16.
+
+    The per-sample detector is what is left of the cost, so the summary
+    detector mode also runs it once per run: the run's peak and mean |x| are
+    found in one pass with no dependency between samples, and the envelope
+    takes a single step towards the peak (attack) or the mean (release) with
+    the coefficient raised to the run's length. At N = 16 on the drum-like
+    signal (threshold -30 dB, ratio 10, release 50 ms) stereo time drops by
+    3.0 to 3.3x against full rate, with 0.8 dB at the 99.9th percentile and
+    1.4 dB worst case; over ReferenceVerifier's presets the worst case is
+    3.3 dB (vocal, 5 ms attack, whose envelope the peak step overshoots) and
+    0.28 in sample error. Short releases cap the interval as above, which
+    leaves nothing to save.
+
+    Envelope and last applied gain are shared by both paths, so the interval
+    can change between blocks without a click.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class ControlRateCompressor
+{
+public:
+    ControlRateCompressor();
+
+    void prepare(const juce::dsp::ProcessSpec& spec);
+    void reset() noexcept;
+
+    void setThreshold(float newThresholdDb);
+    void setRatio(float newRatio);
+    void setAttack(float newAttackMs);
+    void setRelease(float newReleaseMs);
+
+    /** 1 runs at full rate; larger values up to maxControlInterval decimate.
+        Safe to call from any thread, takes effect at the next block.
+    */
+    void setControlInterval(int newInterval) noexcept;
+
+    /** With an interval above 1, also runs the envelope detector once per run,
+        on the run's peak, instead of on every sample. Any thread, next block.
+    */
+    void setSummaryDetector(bool shouldSummarise) noexcept;
+
+    static constexpr int maxControlInterval = 16;
+
+    /** Optional per-sample record of what the detector did: the envelope and
+        the applied (linear) gain of each channel, sized like the context.
+    */
+    struct DetectorTap
+    {
+        juce::dsp::AudioBlock<float> envelope;
+        juce::dsp::AudioBlock<float> gain;
+    };
+
+    template <typename ProcessContext>
+    void process(const ProcessContext& context, const DetectorTap* tap = nullptr) noexcept
+    {
+        const auto& inputBlock = context.getInputBlock();
+        auto& outputBlock = context.getOutputBlock();
+        const auto numChannels = outputBlock.getNumChannels();
+        const auto numSamples = (int)outputBlock.getNumSamples();
+
+        jassert(inputBlock.getNumChannels() == numChannels);
+        jassert((int)inputBlock.getNumSamples() == numSamples);
+
+        if (context.isBypassed)
+        {
+            if (context.usesSeparateInputAndOutputBlocks())
+                outputBlock.copyFrom(inputBlock);
+
+            if (tap != nullptr)
+            {
+                tap->envelope.clear();
+                tap->gain.fill(1.0f);
+            }
+
+            return;
+        }
+
+        auto envelopeTap = [tap](size_t channel) { return tap != nullptr ? tap->envelope.getChannelPointer(channel) : nullptr; };
+        auto gainTap = [tap](size_t channel) { return tap != nullptr ? tap->gain.getChannelPointer(channel) : nullptr; };
+
+        const int interval = juce::jmin(controlInterval.load(std::memory_order_relaxed), releaseIntervalLimit);
+        const bool summarise = summaryDetector.load(std::memory_order_relaxed);
+
+        if (interval <= 1)
+        {
+            for (size_t channel = 0; channel < numChannels; ++channel)
+                processFullRate(envelopes[channel], lastGains[channel],
+                                inputBlock.getChannelPointer(channel), outputBlock.getChannelPointer(channel), numSamples,
+                                envelopeTap(channel), gainTap(channel));
+            return;
+        }
+
+        size_t channel = 0;
+
+        for (; channel + 1 < numChannels; channel += 2)
+        {
+            const float* in[] = { inputBlock.getChannelPointer(channel), inputBlock.getChannelPointer(channel + 1) };
+            float* out[] = { outputBlock.getChannelPointer(channel), outputBlock.getChannelPointer(channel + 1) };
+            float* envelopeTaps[] = { envelopeTap(channel), envelopeTap(channel + 1) };
+            float* gainTaps[] = { gainTap(channel), gainTap(channel + 1) };
+            processDecimated<2>(channel, in, out, numSamples, interval, summarise, envelopeTaps, gainTaps);
+        }
+
+        if (channel < numChannels)
+        {
+            const float* in[] = { inputBlock.getChannelPointer(channel) };
+            float* out[] = { outputBlock.getChannelPointer(channel) };
+            float* envelopeTaps[] = { envelopeTap(channel) };
+            float* gainTaps[] = { gainTap(channel) };
+            processDecimated<1>(channel, in, out, numSamples, interval, summarise, envelopeTaps, gainTaps);
+        }
+    }
+
+    /** The full-rate path for a single sample, as juce::dsp::Compressor::processSample. */
+    float processSample(int channel, float inputValue) noexcept;
+
+private:
+    void update();
+    float calculateCte(float timeMs) const noexcept;
+    float computeGain(float envelope) const noexcept;
+    // The tap pointers are null unless a DetectorTap was passed to process().
+    void processFullRate(float& env, float& gain, const float* in, float* out, int numSamples,
+                         float* envelopeTap, float* gainTap) const noexcept;
+    template <int NumChannels>
+    void processDecimated(size_t firstChannel, const float* const* in, float* const* out, int numSamples, int interval,
+                          bool summarise, float* const* envelopeTap, float* const* gainTap) noexcept;
+
+    // Envelope rise within one run (about 1 dB) above which it is redone at full rate.
+    static constexpr float attackFallbackRatio = 1.12f;
+
+    // Release the envelope may fall through within one run (about 0.5 dB);
+    // faster releases shorten the interval instead.
+    static constexpr float maxReleasePerRun = 0.94f;
+    int releaseIntervalLimit{ maxControlInterval };
+
+    std::vector<float> envelopes;
+    std::vector<float> lastGains;
+
+    double sampleRate{ 44100.0 };
+    float thresholdDb{ 0.0f }, ratio{ 1.0f }, attackTime{ 1.0f }, releaseTime{ 100.0f };
+    float threshold{ 1.0f }, thresholdInverse{ 1.0f }, ratioInverse{ 1.0f };
+    float cteAttack{ 0.0f }, cteRelease{ 0.0f };
+    // cteAttack and cteRelease to the power of a run's length, for the summary detector.
+    std::array<float, maxControlInterval + 1> runAttack{}, runRelease{};
+    std::atomic<int> controlInterval{ 1 };
+    std::atomic<bool> summaryDetector{ false };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ControlRateCompressor)
+};
@@ -0,0 +1,250 @@
+/*
+  ==============================================================================
+
+    DriveStage.cpp
+
+  ==============================================================================
+*/
+
+#include "DriveStage.h"
+#include "FastMath.h"
+
+namespace
+{
+    constexpr float ln2 = 0.69314718f;
+    constexpr float log2e = 1.44269504f;
+
+    // e^(-2|x|), shared by tanh and log cosh.
+    inline float expMinusTwoAbs(float x) noexcept
+    {
+        return FastMath::exp2(-2.0f * log2e * std::abs(x));
+    }
+
+    inline float fastTanh(float x) noexcept
+    {
+        const auto e = expMinusTwoAbs(x);
+        const auto magnitude = (1.0f - e) / (1.0f + e);
+        return x < 0.0f ? -magnitude : magnitude;
+    }
+
+    // log cosh(x) - |x| = log(1 + e^(-2|x|)) - log 2
+    inline float logCoshMinusAbs(float x) noexcept
+    {
+        return ln2 * FastMath::log2(1.0f + expMinusTwoAbs(x)) - ln2;
+    }
+
+    // Each curve has unity gain at zero. antiderivativeMinusAbs() is F(x) - |x|
+    // with F(0) == 0. Piecewise curves evaluate both pieces before selecting,
+    // which the vectoriser needs, so neither piece may produce NaN anywhere.
+    struct TanhCurve
+    {
+        static float apply(float x) noexcept { return fastTanh(x); }
+        static float antiderivativeMinusAbs(float x) noexcept { return logCoshMinusAbs(x); }
+    };
+
+    // x / (1 + x) above zero, softening towards 1; tanh below.
+    struct TubeCurve
+    {
+        static float apply(float x) noexcept
+        {
+            const auto positive = x / (1.0f + std::abs(x));
+            const auto negative = fastTanh(x);
+            return x >= 0.0f ? positive : negative;
+        }
+
+        // x - log(1 + x) above zero
+        static float antiderivativeMinusAbs(float x) noexcept
+        {
+            const auto positive = -ln2 * FastMath::log2(1.0f + std::abs(x));
+            const auto negative = logCoshMinusAbs(x);
+            return x >= 0.0f ? positive : negative;
+        }
+    };
+
+    struct HardClipCurve
+    {
+        static float apply(float x) noexcept { return std::min(1.0f, std::max(-1.0f, x)); }
+
+        // x^2 / 2 inside the rails, |x| - 1/2 outside
+        static float antiderivativeMinusAbs(float x) noexcept
+        {
+            const auto magnitude = std::abs(x);
+            return magnitude <= 1.0f ? (0.5f * magnitude - 1.0f) * magnitude : -0.5f;
+        }
+    };
+}
+
+//==============================================================================
+void DriveStage::prepare(const juce::dsp::ProcessSpec& spec)
+{
+    driveGain.prepare(spec);
+    driveGain.setRampDurationSeconds(0.01);
+
+    oversampler = std::make_unique<juce::dsp::Oversampling<float>>(spec.numChannels, 1,
+                                                                   juce::dsp::Oversampling<float>::filterHalfBandFIREquiripple,
+                                                                   true, true);
+    oversampler->initProcessing(spec.maximumBlockSize);
+    oversamplerLatency = juce::roundToInt(oversampler->getLatencyInSamples());
+
+    const auto maxCurveSamples = (size_t)oversampler->getOversamplingFactor() * spec.maximumBlockSize + 1;
+    inputScratch.allocate(maxCurveSamples, true);
+    antiderivativeScratch.allocate(maxCurveSamples, true);
+
+    lastInputs.assign(spec.numChannels, 0.0f);
+    dcLastInputs.assign(spec.numChannels, 0.0f);
+    dcLastOutputs.assign(spec.numChannels, 0.0f);
+    dcCoefficient = (float)std::exp(-juce::MathConstants<double>::twoPi * 10.0 / spec.sampleRate);
+
+    updateMode();
+    reset();
+}
+
+void DriveStage::reset() noexcept
+{
+    driveGain.reset();
+
+    if (oversampler != nullptr)
+        oversampler->reset();
+
+    std::fill(lastInputs.begin(), lastInputs.end(), 0.0f);
+    std::fill(dcLastInputs.begin(), dcLastInputs.end(), 0.0f);
+    std::fill(dcLastOutputs.begin(), dcLastOutputs.end(), 0.0f);
+}
+
+void DriveStage::setDriveDecibels(float newDriveDb) noexcept
+{
+    driveGain.setGainDecibels(newDriveDb);
+}
+
+void DriveStage::setCurve(Curve newCurve) noexcept
+{
+    curveSetting.store((int)newCurve);
+}
+
+void DriveStage::setOversampling(bool shouldOversample) noexcept
+{
+    oversamplingSetting.store(shouldOversample);
+}
+
+int DriveStage::getLatencySamples() const noexcept
+{
+    const bool active = curveSetting.load() != (int)Curve::off;
+    return active && oversamplingSetting.load() ? oversamplerLatency : 0;
+}
+
+void DriveStage::updateMode() noexcept
+{
+    const auto newCurve = (Curve)curveSetting.load();
+    const bool newOversampling = newCurve != Curve::off && oversamplingSetting.load();
+
+    // Coming back from off, or switching rate, the stored state no longer
+    // belongs to the signal about to be processed.
+    if ((curve == Curve::off && newCurve != Curve::off) || newOversampling != oversampling)
+        reset();
+    else if (newCurve == Curve::tube && curve != Curve::tube)
+        std::fill(dcLastOutputs.begin(), dcLastOutputs.end(), 0.0f);
+
+    curve = newCurve;
+    oversampling = newOversampling;
+}
+
+void DriveStage::process(const juce::dsp::ProcessContextReplacing<float>& context) noexcept
+{
+    updateMode();
+
+    if (curve == Curve::off || context.isBypassed)
+        return;
+
+    auto& block = context.getOutputBlock();
+    driveGain.process(context);
+
+    if (oversampling)
+    {
+        auto upsampled = oversampler->processSamplesUp(block);
+        processCurve(upsampled);
+        oversampler->processSamplesDown(block);
+    }
+    else
+    {
+        processCurve(block);
+    }
+
+    if (curve == Curve::tube)
+        removeDc(block);
+}
+
+void DriveStage::processCurve(juce::dsp::AudioBlock<float>& block) noexcept
+{
+    const auto numSamples = (int)block.getNumSamples();
+
+    for (size_t channel = 0; channel < block.getNumChannels(); ++channel)
+    {
+        auto* samples = block.getChannelPointer(channel);
+        auto& lastInput = lastInputs[channel];
+
+        switch (curve)
+        {
+            case Curve::tanh:       processChannel<TanhCurve>(samples, numSamples, lastInput); break;
+            case Curve::tube:       processChannel<TubeCurve>(samples, numSamples, lastInput); break;
+            case Curve::hardClip:   processChannel<HardClipCurve>(samples, numSamples, lastInput); break;
+            case Curve::off:        break;
+        }
+    }
+}
+
+template <typename CurveType>
+void DriveStage::processChannel(float* samples, int numSamples, float& lastInput) noexcept
+{
+    // Inputs and antiderivatives go to scratch first, one sample ahead of
+    // the block, so both loops below are independent per sample.
+    auto* inputs = inputScratch.get();
+    auto* antiderivatives = antiderivativeScratch.get();
+
+    inputs[0] = lastInput;
+    antiderivatives[0] = CurveType::antiderivativeMinusAbs(lastInput);
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        inputs[i + 1] = samples[i];
+        antiderivatives[i + 1] = CurveType::antiderivativeMinusAbs(samples[i]);
+    }
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const auto previous = inputs[i];
+        const auto current = inputs[i + 1];
+        const auto step = current - previous;
+        const bool illConditioned = std::abs(step) < illConditionedStep;
+
+        const auto quotient = (std::abs(current) - std::abs(previous) + antiderivatives[i + 1] - antiderivatives[i])
+                            / (illConditioned ? 1.0f : step);
+        const auto midpoint = CurveType::apply(0.5f * (previous + current));
+
+        samples[i] = illConditioned ? midpoint : quotient;
+    }
+
+    lastInput = inputs[numSamples];
+}
+
+void DriveStage::removeDc(juce::dsp::AudioBlock<float>& block) noexcept
+{
+    const auto numSamples = (int)block.getNumSamples();
+
+    for (size_t channel = 0; channel < block.getNumChannels(); ++channel)
+    {
+        auto* samples = block.getChannelPointer(channel);
+        auto x1 = dcLastInputs[channel];
+        auto y1 = dcLastOutputs[channel];
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const auto x = samples[i];
+            y1 = x - x1 + dcCoefficient * y1;
+            x1 = x;
+            samples[i] = y1;
+        }
+
+        dcLastInputs[channel] = x1;
+        dcLastOutputs[channel] = y1;
+    }
+}
@@ -0,0 +1,87 @@
+/*
+  ==============================================================================
+
+    DriveStage.h
+
+    Saturation between the compressor and the output gain: drive gain, then
+    one of a few static curves (tanh, an asymmetric tube-style curve and a
+    hard clip) with first-order antiderivative anti-aliasing (ADAA).
+
+    ADAA replaces f(x[n]) by the mean of f over the segment from x[n-1] to
+    x[n], (F(x[n]) - F(x[n-1])) / (x[n] - x[n-1]) with F the antiderivative,
+    which suppresses the aliased partials of the curve well enough to run at
+    the host rate. It costs half a sample of delay, which is not reported.
+    2x oversampling is still available on top; it uses the integer latency
+    FIR filters so the parallel dry path can be delayed to match exactly.
+
+    Curves and antiderivatives are built from FastMath and selects only, so
+    both per-sample loops vectorise where the compiler if-converts float
+    selects (GCC needs -fno-trapping-math for that; see FastMath.h). Every antiderivative approaches |x| for
+    large inputs, so F(x) - |x| is what gets stored; that keeps the
+    difference quotient from cancelling to noise in float at high drive.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class DriveStage
+{
+public:
+    /** Same order as the "driveType" parameter's choices. */
+    enum class Curve { off, tanh, tube, hardClip };
+
+    void prepare(const juce::dsp::ProcessSpec& spec);
+    void reset() noexcept;
+
+    void setDriveDecibels(float newDriveDb) noexcept;
+
+    /** Safe to call from any thread; picked up at the start of the next block. */
+    void setCurve(Curve newCurve) noexcept;
+    void setOversampling(bool shouldOversample) noexcept;
+
+    /** Latency the current settings need, for reporting to the host. */
+    int getLatencySamples() const noexcept;
+    int getMaximumLatencySamples() const noexcept { return oversamplerLatency; }
+
+    /** Latency the last block was processed with, for lining the dry path up. */
+    int getProcessedLatencySamples() const noexcept { return oversampling ? oversamplerLatency : 0; }
+
+    void process(const juce::dsp::ProcessContextReplacing<float>& context) noexcept;
+
+private:
+    void updateMode() noexcept;
+
+    template <typename CurveType>
+    void processChannel(float* samples, int numSamples, float& lastInput) noexcept;
+    void processCurve(juce::dsp::AudioBlock<float>& block) noexcept;
+    void removeDc(juce::dsp::AudioBlock<float>& block) noexcept;
+
+    // Below this input step the mean of f over the step is taken at its
+    // midpoint instead, where the difference quotient is ill-conditioned.
+    static constexpr float illConditionedStep = 1.0e-3f;
+
+    juce::dsp::Gain<float> driveGain;
+    std::unique_ptr<juce::dsp::Oversampling<float>> oversampler;
+    int oversamplerLatency{ 0 };
+
+    std::atomic<int> curveSetting{ (int)Curve::off };
+    std::atomic<bool> oversamplingSetting{ false };
+    Curve curve{ Curve::off };
+    bool oversampling{ false };
+
+    // Last input of each channel at the rate the curve runs at.
+    std::vector<float> lastInputs;
+
+    // The tube curve is asymmetric, so its DC is taken out with a 10 Hz one-pole high-pass.
+    std::vector<float> dcLastInputs;
+    std::vector<float> dcLastOutputs;
+    float dcCoefficient{ 0.0f };
+
+    juce::HeapBlock<float> inputScratch;
+    juce::HeapBlock<float> antiderivativeScratch;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DriveStage)
+};
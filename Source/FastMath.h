@@ -0,0 +1,80 @@
+/*
+  ==============================================================================
+
+    FastMath.h
+
+    Branch-free float approximations for the hot loops. They only use plain
+    arithmetic, selects and int/float bit casts, so loops over contiguous
+    arrays that call them are picked up by the compiler's auto-vectoriser
+    (std::pow / std::log are not). GCC keeps float selects as branches
+    unless -fno-trapping-math is given, which the Linux exporter sets; with
+    it GCC 12 vectorises StripRack's and DriveStage's loops at -O3. MSVC's
+    /fp:precise has no such restriction, but its vectoriser report has not
+    been checked on these loops.
+
+    Checked against every float: log2 is within 4e-6 absolute over the
+    normal range, dominated by rounding the result itself near +-126 (2e-7
+    for x in [1/2, 2), 6e-7 up to 1024), and exp2 within 2.6e-7 relative
+    (2.2e-6 dB) over [-126, 126]. ReferenceVerifier's "fast math" case
+    holds both. The edge values the compressor relies on are exact:
+    log2(1) == 0, exp2(0) == 1.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+namespace FastMath
+{
+    inline float bitsToFloat(std::int32_t bits) noexcept
+    {
+        float f;
+        std::memcpy(&f, &bits, sizeof(f));
+        return f;
+    }
+
+    inline std::int32_t floatToBits(float f) noexcept
+    {
+        std::int32_t bits;
+        std::memcpy(&bits, &f, sizeof(bits));
+        return bits;
+    }
+
+    /** Base 2 logarithm for x > 0 (denormals and zero are not handled). */
+    inline float log2(float x) noexcept
+    {
+        const auto bits = floatToBits(x);
+        auto exponent = (float)(((bits >> 23) & 0xff) - 127);
+        auto mantissa = bitsToFloat((bits & 0x007fffff) | 0x3f800000);
+
+        // Fold the mantissa into [sqrt(1/2), sqrt(2)) so the series below converges quickly.
+        const bool fold = mantissa > 1.41421356f;
+        mantissa = fold ? mantissa * 0.5f : mantissa;
+        exponent = fold ? exponent + 1.0f : exponent;
+
+        // ln(m) = 2 atanh(s), s = (m - 1) / (m + 1), |s| < 0.172
+        const auto s = (mantissa - 1.0f) / (mantissa + 1.0f);
+        const auto s2 = s * s;
+        const auto series = s * (2.0f + s2 * (2.0f / 3.0f + s2 * (2.0f / 5.0f + s2 * (2.0f / 7.0f))));
+
+        return exponent + series * 1.44269504f;
+    }
+
+    /** 2 to the power x, clamped to the normal float range. */
+    inline float exp2(float x) noexcept
+    {
+        x = x < -126.0f ? -126.0f : (x > 126.0f ? 126.0f : x);
+
+        const auto whole = (std::int32_t)(x + (x >= 0.0f ? 0.5f : -0.5f));
+        const auto f = (x - (float)whole) * 0.69314718f;
+
+        // e^f for |f| <= ln(2) / 2
+        const auto poly = 1.0f + f * (1.0f + f * (1.0f / 2.0f + f * (1.0f / 6.0f + f * (1.0f / 24.0f
+                        + f * (1.0f / 120.0f + f * (1.0f / 720.0f))))));
+
+        return poly * bitsToFloat((whole + 127) << 23);
+    }
+}
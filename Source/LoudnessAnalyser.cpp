@@ -0,0 +1,382 @@
+/*
+  ==============================================================================
+
+    LoudnessAnalyser.cpp
+
+  ==============================================================================
+*/
+
+#include "LoudnessAnalyser.h"
+
+namespace
+{
+    constexpr float minusInfinity = -std::numeric_limits<float>::infinity();
+    constexpr int maxSamplesPerSlice = 8192;
+    constexpr double fifoSeconds = 0.1;
+    constexpr int minFifoBlocks = 4;
+}
+
+//==============================================================================
+void LoudnessAnalyser::Histogram::add(double energy) noexcept
+{
+    const auto lufs = energyToLufs(energy);
+
+    if (lufs < minLufs)
+        return;
+
+    const auto bin = juce::jlimit(0, numBins - 1, (int)((lufs - minLufs) / binWidth));
+    ++counts[(size_t)bin];
+    energies[(size_t)bin] += energy;
+    ++totalCount;
+    totalEnergy += energy;
+}
+
+void LoudnessAnalyser::Histogram::clear() noexcept
+{
+    counts.fill(0);
+    energies.fill(0.0);
+    totalCount = 0;
+    totalEnergy = 0.0;
+}
+
+float LoudnessAnalyser::Histogram::getGatedLoudness(float relativeGateLu) const noexcept
+{
+    // Everything in the histogram already passed the absolute gate.
+    if (totalCount == 0)
+        return minusInfinity;
+
+    const auto gate = energyToLufs(totalEnergy / (double)totalCount) + relativeGateLu;
+    juce::int64 count = 0;
+    double energy = 0.0;
+
+    for (int bin = 0; bin < numBins; ++bin)
+    {
+        if (binLoudness(bin) + binWidth <= gate)
+            continue;
+
+        count += counts[(size_t)bin];
+        energy += energies[(size_t)bin];
+    }
+
+    return count > 0 ? energyToLufs(energy / (double)count) : minusInfinity;
+}
+
+float LoudnessAnalyser::Histogram::getLoudnessRange() const noexcept
+{
+    // EBU Tech 3342: short-term values gated at -70 LUFS and -20 LU relative,
+    // range is the spread between the 10th and 95th percentiles.
+    if (totalCount == 0)
+        return 0.0f;
+
+    const auto gate = energyToLufs(totalEnergy / (double)totalCount) - 20.0f;
+    int firstBin = 0;
+    juce::int64 count = 0;
+
+    for (int bin = numBins; --bin >= 0;)
+    {
+        if (binLoudness(bin) + binWidth <= gate)
+        {
+            firstBin = bin + 1;
+            break;
+        }
+
+        count += counts[(size_t)bin];
+    }
+
+    if (count == 0)
+        return 0.0f;
+
+    const auto lowIndex = (juce::int64)std::llround(0.10 * (double)(count - 1));
+    const auto highIndex = (juce::int64)std::llround(0.95 * (double)(count - 1));
+    float low = 0.0f, high = 0.0f;
+    juce::int64 seen = 0;
+
+    for (int bin = firstBin; bin < numBins; ++bin)
+    {
+        const auto next = seen + counts[(size_t)bin];
+
+        if (seen <= lowIndex && lowIndex < next)
+            low = binLoudness(bin);
+
+        if (seen <= highIndex && highIndex < next)
+        {
+            high = binLoudness(bin);
+            break;
+        }
+
+        seen = next;
+    }
+
+    return high - low;
+}
+
+float LoudnessAnalyser::energyToLufs(double energy) noexcept
+{
+    return energy > 0.0 ? (float)(-0.691 + 10.0 * std::log10(energy)) : minusInfinity;
+}
+
+//==============================================================================
+LoudnessAnalyser::LoudnessAnalyser(juce::TimeSliceThread& t)
+    : thread(t)
+{
+    // 4x interpolation filter for true peak: 48 tap Hann windowed sinc split
+    // into four 12 tap phases, as in BS.1770 Annex 2.
+    for (int i = 0; i < 48; ++i)
+    {
+        const auto x = ((double)i - 23.5) / 4.0;
+        const auto sinc = std::sin(juce::MathConstants<double>::pi * x) / (juce::MathConstants<double>::pi * x);
+        const auto window = 0.5 - 0.5 * std::cos(juce::MathConstants<double>::twoPi * ((double)i + 0.5) / 48.0);
+        truePeakPhases[(size_t)(i % 4)][(size_t)(i / 4)] = (float)(sinc * window);
+    }
+
+    clearStatistics();
+    publishReadings();
+}
+
+LoudnessAnalyser::~LoudnessAnalyser()
+{
+    thread.removeTimeSliceClient(this);
+}
+
+void LoudnessAnalyser::prepare(double sampleRate, int newNumChannels, int maximumBlockSize)
+{
+    // Waits for a running slice to finish, so the worker state below is ours.
+    thread.removeTimeSliceClient(this);
+
+    numChannels = newNumChannels;
+
+    // An AbstractFifo holds one sample less than its size.
+    const int capacity = juce::jmax(juce::roundToInt(sampleRate * fifoSeconds), minFifoBlocks * maximumBlockSize) + 1;
+    fifoBuffer.setSize(numChannels, capacity);
+    fifo.setTotalSize(capacity);
+    fifo.reset();
+
+    const auto fifoMilliseconds = 1000.0 * (capacity - 1) / sampleRate;
+    activePollMilliseconds = juce::jmax(1, (int)(fifoMilliseconds / 4.0));
+    idlePollMilliseconds = juce::jmax(1, (int)(fifoMilliseconds / 2.0));
+
+    // K-weighting pre-filter and RLB high-pass, recalculated for any sample
+    // rate from the analogue prototypes behind the 48 kHz coefficients.
+    const auto pi = juce::MathConstants<double>::pi;
+
+    auto k = std::tan(pi * 1681.974450955533 / sampleRate);
+    const auto q1 = 0.7071752369554196;
+    const auto vh = std::pow(10.0, 3.999843853973347 / 20.0);
+    const auto vb = std::pow(vh, 0.4996667741545416);
+    auto a0 = 1.0 + k / q1 + k * k;
+    const Biquad shelf{ (vh + vb * k / q1 + k * k) / a0, 2.0 * (k * k - vh) / a0, (vh - vb * k / q1 + k * k) / a0,
+                        2.0 * (k * k - 1.0) / a0, (1.0 - k / q1 + k * k) / a0 };
+
+    k = std::tan(pi * 38.13547087602444 / sampleRate);
+    const auto q2 = 0.5003270373238773;
+    a0 = 1.0 + k / q2 + k * k;
+    const Biquad highPass{ 1.0, -2.0, 1.0, 2.0 * (k * k - 1.0) / a0, (1.0 - k / q2 + k * k) / a0 };
+
+    kWeighting.assign((size_t)numChannels, { shelf, highPass });
+    truePeakHistory.assign((size_t)numChannels, {});
+
+    subBlockLength = juce::jmax(1, juce::roundToInt(sampleRate * 0.1));
+    clearStatistics();
+    publishReadings();
+    droppedSamples.store(0);
+    resetPending.store(false);
+
+    thread.addTimeSliceClient(this);
+}
+
+void LoudnessAnalyser::pushBlock(const juce::AudioBuffer<float>& buffer, bool waitForSpace) noexcept
+{
+    const int numSamples = buffer.getNumSamples();
+    const int channels = juce::jmin(numChannels, buffer.getNumChannels());
+
+    if (channels == 0)
+        return;
+
+    const int maxPieceLength = fifo.getTotalSize() - 1;
+
+    for (int start = 0; start < numSamples;)
+    {
+        const int length = juce::jmin(maxPieceLength, numSamples - start);
+
+        while (fifo.getFreeSpace() < length)
+        {
+            if (!waitForSpace)
+            {
+                droppedSamples += numSamples - start;
+                return;
+            }
+
+            // Offline only, so taking the thread's lock is fine: call the
+            // worker now rather than waiting out its poll interval.
+            thread.moveToFrontOfQueue(this);
+            spaceAvailable.wait(10);
+        }
+
+        const auto scope = fifo.write(length);
+
+        for (int ch = 0; ch < channels; ++ch)
+        {
+            if (scope.blockSize1 > 0)
+                fifoBuffer.copyFrom(ch, scope.startIndex1, buffer, ch, start, scope.blockSize1);
+            if (scope.blockSize2 > 0)
+                fifoBuffer.copyFrom(ch, scope.startIndex2, buffer, ch, start + scope.blockSize1, scope.blockSize2);
+        }
+
+        start += length;
+    }
+}
+
+LoudnessAnalyser::Readings LoudnessAnalyser::getReadings() const noexcept
+{
+    return { momentaryLufs.load(), shortTermLufs.load(), integratedLufs.load(),
+             loudnessRangeLu.load(), truePeakDb.load(), droppedSamples.load() };
+}
+
+bool LoudnessAnalyser::waitUntilAnalysed(int timeoutMs) const
+{
+    const auto deadline = juce::Time::getMillisecondCounter() + (juce::uint32)timeoutMs;
+
+    while (fifo.getNumReady() > 0 || busy.load())
+    {
+        if (juce::Time::getMillisecondCounter() >= deadline)
+            return false;
+
+        juce::Thread::sleep(1);
+    }
+
+    return true;
+}
+
+//==============================================================================
+int LoudnessAnalyser::useTimeSlice()
+{
+    busy.store(true);
+
+    if (resetPending.exchange(false))
+    {
+        clearStatistics();
+        publishReadings();
+    }
+
+    const int numReady = fifo.getNumReady();
+
+    // Nothing new: back off. Half the FIFO's length still leaves room for
+    // what arrives before the next poll.
+    if (numReady == 0)
+    {
+        busy.store(false);
+        return idlePollMilliseconds;
+    }
+
+    auto analyseRange = [this](int start, int length)
+    {
+        for (int i = start; i < start + length; ++i)
+        {
+            for (int ch = 0; ch < numChannels; ++ch)
+                analyseSample(ch, fifoBuffer.getSample(ch, i));
+
+            if (++subBlockSamples == subBlockLength)
+                finishSubBlock();
+        }
+    };
+
+    const int numToRead = juce::jmin(numReady, maxSamplesPerSlice);
+
+    {
+        const auto scope = fifo.read(numToRead);
+        analyseRange(scope.startIndex1, scope.blockSize1);
+        analyseRange(scope.startIndex2, scope.blockSize2);
+    }
+
+    spaceAvailable.signal();
+    publishReadings();
+
+    busy.store(false);
+    return numToRead < numReady ? 0 : activePollMilliseconds;
+}
+
+void LoudnessAnalyser::analyseSample(int channel, float sample) noexcept
+{
+    auto& filters = kWeighting[(size_t)channel];
+    const auto weighted = filters[1].process(filters[0].process((double)sample));
+    subBlockSum += weighted * weighted;
+
+    auto& history = truePeakHistory[(size_t)channel];
+    std::memmove(history.data() + 1, history.data(), (history.size() - 1) * sizeof(float));
+    history[0] = sample;
+
+    auto peak = std::abs(sample);
+
+    for (const auto& phase : truePeakPhases)
+    {
+        float y = 0.0f;
+
+        for (size_t k = 0; k < phase.size(); ++k)
+            y += phase[k] * history[k];
+
+        peak = juce::jmax(peak, std::abs(y));
+    }
+
+    truePeak = juce::jmax(truePeak, peak);
+}
+
+void LoudnessAnalyser::finishSubBlock() noexcept
+{
+    // 100 ms hops: momentary is the last 400 ms (75% overlap, which is also
+    // the integrated gating block), short-term the last 3 s.
+    subBlockEnergies[(size_t)(subBlocksDone % subBlocksPerShortTerm)] = subBlockSum / (double)subBlockLength;
+    ++subBlocksDone;
+    subBlockSamples = 0;
+    subBlockSum = 0.0;
+
+    auto average = [this](int numSubBlocks)
+    {
+        double sum = 0.0;
+
+        for (int i = 1; i <= numSubBlocks; ++i)
+            sum += subBlockEnergies[(size_t)((subBlocksDone - i) % subBlocksPerShortTerm)];
+
+        return sum / (double)numSubBlocks;
+    };
+
+    if (subBlocksDone >= subBlocksPerMomentary)
+    {
+        momentaryEnergy = average(subBlocksPerMomentary);
+        integratedBlocks.add(momentaryEnergy);
+    }
+
+    if (subBlocksDone >= subBlocksPerShortTerm)
+    {
+        shortTermEnergy = average(subBlocksPerShortTerm);
+        shortTermBlocks.add(shortTermEnergy);
+    }
+}
+
+void LoudnessAnalyser::clearStatistics() noexcept
+{
+    for (auto& filters : kWeighting)
+        for (auto& filter : filters)
+            filter.z1 = filter.z2 = 0.0;
+
+    for (auto& history : truePeakHistory)
+        history.fill(0.0f);
+
+    subBlockEnergies.fill(0.0);
+    subBlockSamples = 0;
+    subBlocksDone = 0;
+    subBlockSum = 0.0;
+    momentaryEnergy = 0.0;
+    shortTermEnergy = 0.0;
+    truePeak = 0.0f;
+    integratedBlocks.clear();
+    shortTermBlocks.clear();
+}
+
+void LoudnessAnalyser::publishReadings() noexcept
+{
+    momentaryLufs.store(energyToLufs(momentaryEnergy));
+    shortTermLufs.store(energyToLufs(shortTermEnergy));
+    integratedLufs.store(integratedBlocks.getGatedLoudness(-10.0f));
+    loudnessRangeLu.store(shortTermBlocks.getLoudnessRange());
+    truePeakDb.store(truePeak > 0.0f ? juce::Decibels::gainToDecibels(truePeak, -200.0f) : minusInfinity);
+}
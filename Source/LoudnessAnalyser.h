@@ -0,0 +1,151 @@
+/*
+  ==============================================================================
+
+    LoudnessAnalyser.h
+
+    ITU-R BS.1770 / EBU R128 loudness and true peak of the plugin output.
+    The audio thread only copies each block into a lock-free FIFO; K-weighting,
+    gating, loudness range statistics and 4x oversampled true peak detection
+    all run on a shared background thread.
+
+    The FIFO holds about 100 ms (at least four blocks), and the worker polls
+    it at a quarter of that while audio arrives and half of it while the FIFO
+    is empty, so an instance the host isn't feeding polls twenty times a
+    second rather than a hundred.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class LoudnessAnalyser : private juce::TimeSliceClient
+{
+public:
+    /** Loudness values are in LUFS, loudness range in LU, true peak in dBTP.
+        Anything not measured yet (or silent) reads as minus infinity.
+        droppedSamples counts samples (per channel) that never reached the
+        analysis since prepare() or resetStatistics(); when it is non-zero the
+        integrated loudness and loudness range are missing programme.
+    */
+    struct Readings
+    {
+        float momentaryLufs;
+        float shortTermLufs;
+        float integratedLufs;
+        float loudnessRangeLu;
+        float truePeakDb;
+        juce::int64 droppedSamples;
+    };
+
+    explicit LoudnessAnalyser(juce::TimeSliceThread& thread);
+    ~LoudnessAnalyser() override;
+
+    /** Not concurrent with pushBlock(); restarts all statistics. */
+    void prepare(double sampleRate, int numChannels, int maximumBlockSize);
+
+    /** Audio thread. Copies the block into the FIFO, in pieces if it is
+        longer than the FIFO. When the FIFO is full the rest of the block is
+        dropped and counted, unless waitForSpace is set (offline rendering),
+        in which case it brings the worker forward and waits for it to make room.
+    */
+    void pushBlock(const juce::AudioBuffer<float>& buffer, bool waitForSpace) noexcept;
+
+    /** Any thread. */
+    Readings getReadings() const noexcept;
+    juce::int64 getNumDroppedSamples() const noexcept { return droppedSamples.load(); }
+
+    /** Clears integrated loudness, loudness range, true peak and the drop count, e.g. at the start of a render. */
+    void resetStatistics() noexcept
+    {
+        droppedSamples.store(0);
+        resetPending.store(true);
+    }
+
+    /** Blocks until everything pushed so far has been analysed, so an offline
+        renderer can query final values. Returns false on timeout.
+    */
+    bool waitUntilAnalysed(int timeoutMs) const;
+
+private:
+    int useTimeSlice() override;
+    void analyseSample(int channel, float sample) noexcept;
+    void finishSubBlock() noexcept;
+    void clearStatistics() noexcept;
+    void publishReadings() noexcept;
+
+    struct Biquad
+    {
+        double b0, b1, b2, a1, a2;
+        double z1{ 0.0 }, z2{ 0.0 };
+
+        double process(double x) noexcept
+        {
+            const auto y = b0 * x + z1;
+            z1 = b1 * x - a1 * y + z2;
+            z2 = b2 * x - a2 * y;
+            return y;
+        }
+    };
+
+    /** Loudness histogram at 0.1 LU resolution, as used for both the
+        integrated gate and the loudness range, so memory and update cost stay
+        constant however long the programme runs.
+    */
+    struct Histogram
+    {
+        static constexpr float minLufs = -70.0f;
+        static constexpr float binWidth = 0.1f;
+        static constexpr int numBins = 800;
+
+        std::array<juce::int64, numBins> counts{};
+        std::array<double, numBins> energies{};
+        juce::int64 totalCount{ 0 };
+        double totalEnergy{ 0.0 };
+
+        void add(double energy) noexcept;
+        void clear() noexcept;
+        float getGatedLoudness(float relativeGateLu) const noexcept;
+        float getLoudnessRange() const noexcept;
+
+        static float binLoudness(int bin) noexcept { return minLufs + (float)bin * binWidth; }
+    };
+
+    static float energyToLufs(double energy) noexcept;
+
+    juce::TimeSliceThread& thread;
+
+    juce::AbstractFifo fifo{ 1 };
+    juce::AudioBuffer<float> fifoBuffer;
+    std::atomic<juce::int64> droppedSamples{ 0 };
+    juce::WaitableEvent spaceAvailable;
+    std::atomic<bool> resetPending{ false };
+    std::atomic<bool> busy{ false };
+
+    // Worker thread state.
+    int numChannels{ 0 };
+    int activePollMilliseconds{ 10 }, idlePollMilliseconds{ 10 };
+    std::vector<std::array<Biquad, 2>> kWeighting;
+    std::vector<std::array<float, 12>> truePeakHistory;
+    std::array<std::array<float, 12>, 4> truePeakPhases{};
+    int truePeakPos{ 0 };
+
+    static constexpr int subBlocksPerShortTerm = 30;
+    static constexpr int subBlocksPerMomentary = 4;
+    std::array<double, subBlocksPerShortTerm> subBlockEnergies{};
+    int subBlockLength{ 1 };
+    int subBlockSamples{ 0 };
+    int subBlocksDone{ 0 };
+    double subBlockSum{ 0.0 };
+    double momentaryEnergy{ 0.0 };
+    double shortTermEnergy{ 0.0 };
+    float truePeak{ 0.0f };
+
+    Histogram integratedBlocks;
+    Histogram shortTermBlocks;
+
+    std::atomic<float> momentaryLufs, shortTermLufs, integratedLufs, loudnessRangeLu, truePeakDb;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LoudnessAnalyser)
+};
@@ -0,0 +1,226 @@
+/*
+  ==============================================================================
+
+    MeterDisplays.cpp
+
+  ==============================================================================
+*/
+
+#include "MeterDisplays.h"
+
+namespace
+{
+    const juce::Colour backgroundColour(40u, 40u, 40u);
+    const juce::Colour gridColour(60u, 60u, 60u);
+    const juce::Colour levelColour(110u, 110u, 110u);
+    const juce::Colour reductionColour(230u, 140u, 30u);
+    const juce::Colour cursorColour(200u, 200u, 200u);
+}
+
+//==============================================================================
+GainReductionHistory::GainReductionHistory()
+{
+    setOpaque(true);
+}
+
+void GainReductionHistory::addFrames(const MeterFrame* frames, int numFrames)
+{
+    if (!history.isValid() || numFrames <= 0)
+        return;
+
+    // Anything older than one full width would be overwritten straight away.
+    const int width = history.getWidth();
+    const int first = juce::jmax(0, numFrames - width);
+
+    const int firstX = writeX;
+    juce::Graphics g(history);
+
+    for (int i = first; i < numFrames; ++i)
+    {
+        drawColumn(g, frames[i]);
+        writeX = (writeX + 1) % width;
+    }
+
+    // The columns written plus the cursor's new place; the old one was the first column.
+    repaintColumns(firstX, numFrames - first + 1);
+}
+
+void GainReductionHistory::repaintColumns(int firstX, int numColumns)
+{
+    const int width = history.getWidth();
+
+    if (numColumns >= width)
+    {
+        repaint();
+        return;
+    }
+
+    const int beforeWrap = juce::jmin(numColumns, width - firstX);
+    repaint(firstX, 0, beforeWrap, getHeight());
+
+    if (numColumns > beforeWrap)
+        repaint(0, 0, numColumns - beforeWrap, getHeight());
+}
+
+void GainReductionHistory::drawColumn(juce::Graphics& g, const MeterFrame& frame)
+{
+    const int height = history.getHeight();
+
+    g.setColour(backgroundColour);
+    g.fillRect(writeX, 0, 1, height);
+
+    g.setColour(gridColour);
+    for (float db = -6.0f; db > maxReductionDb; db -= 6.0f)
+        g.fillRect(writeX, juce::roundToInt(juce::jmap(db, 0.0f, maxReductionDb, 0.0f, (float)height)), 1, 1);
+
+    const auto levelHeight = juce::roundToInt(juce::jmap(juce::jlimit(minLevelDb, 0.0f, frame.inputDb),
+                                                         minLevelDb, 0.0f, 0.0f, (float)height));
+    g.setColour(levelColour);
+    g.fillRect(writeX, height - levelHeight, 1, levelHeight);
+
+    const auto reductionHeight = juce::roundToInt(juce::jmap(juce::jlimit(maxReductionDb, 0.0f, frame.gainReductionDb),
+                                                             0.0f, maxReductionDb, 0.0f, (float)height));
+    g.setColour(reductionColour);
+    g.fillRect(writeX, 0, 1, reductionHeight);
+}
+
+void GainReductionHistory::paint(juce::Graphics& g)
+{
+    if (!history.isValid())
+    {
+        g.fillAll(backgroundColour);
+        return;
+    }
+
+    // Columns stay where they were drawn; the cursor covers the oldest one.
+    g.drawImageAt(history, 0, 0);
+
+    g.setColour(cursorColour);
+    g.fillRect(writeX, 0, 1, history.getHeight());
+
+    g.setColour(juce::Colours::black);
+    g.drawRect(getLocalBounds());
+}
+
+void GainReductionHistory::resized()
+{
+    writeX = 0;
+
+    if (getWidth() <= 0 || getHeight() <= 0)
+    {
+        history = {};
+        return;
+    }
+
+    // An empty history: what drawColumn() gives for silence, drawn in one go
+    // rather than column by column, as this runs every time an editor opens.
+    history = juce::Image(juce::Image::RGB, getWidth(), getHeight(), false);
+    juce::Graphics g(history);
+    g.fillAll(backgroundColour);
+
+    g.setColour(gridColour);
+    for (float db = -6.0f; db > maxReductionDb; db -= 6.0f)
+        g.fillRect(0, juce::roundToInt(juce::jmap(db, 0.0f, maxReductionDb, 0.0f, (float)getHeight())), getWidth(), 1);
+}
+
+//==============================================================================
+TransferCurveDisplay::TransferCurveDisplay()
+{
+    setOpaque(true);
+}
+
+void TransferCurveDisplay::setCurve(float newThreshDb, float newRatio)
+{
+    if (newThreshDb == threshDb && newRatio == ratio)
+        return;
+
+    threshDb = newThreshDb;
+    ratio = newRatio;
+    renderCurve();
+    repaint();
+}
+
+void TransferCurveDisplay::setOperatingPoint(float inputDb, float gainReductionDb)
+{
+    const auto inDb = juce::jlimit(minDb, maxDb, inputDb);
+    const auto newDot = toScreen(inDb, juce::jlimit(minDb, maxDb, inDb + gainReductionDb));
+    const bool newVisible = inputDb > minDb;
+
+    if (newDot == dot && newVisible == dotVisible)
+        return;
+
+    if (dotVisible)
+        repaint(getDotArea());
+
+    dot = newDot;
+    dotVisible = newVisible;
+
+    if (dotVisible)
+        repaint(getDotArea());
+}
+
+void TransferCurveDisplay::paint(juce::Graphics& g)
+{
+    if (curve.isValid())
+        g.drawImageAt(curve, 0, 0);
+    else
+        g.fillAll(backgroundColour);
+
+    if (dotVisible)
+    {
+        g.setColour(juce::Colours::white);
+        g.fillEllipse(dot.x - dotRadius, dot.y - dotRadius, dotRadius * 2.0f, dotRadius * 2.0f);
+    }
+}
+
+void TransferCurveDisplay::resized()
+{
+    renderCurve();
+}
+
+juce::Point<float> TransferCurveDisplay::toScreen(float inDb, float outDb) const
+{
+    return { juce::jmap(inDb, minDb, maxDb, 0.0f, (float)getWidth()),
+             juce::jmap(outDb, minDb, maxDb, (float)getHeight(), 0.0f) };
+}
+
+juce::Rectangle<int> TransferCurveDisplay::getDotArea() const
+{
+    return juce::Rectangle<float>(dotRadius * 2.0f, dotRadius * 2.0f).withCentre(dot).expanded(1.0f).getSmallestIntegerContainer();
+}
+
+void TransferCurveDisplay::renderCurve()
+{
+    if (getWidth() <= 0 || getHeight() <= 0)
+    {
+        curve = {};
+        return;
+    }
+
+    curve = juce::Image(juce::Image::RGB, getWidth(), getHeight(), false);
+    juce::Graphics g(curve);
+    g.fillAll(backgroundColour);
+
+    g.setColour(gridColour);
+    for (float db = -48.0f; db < maxDb; db += 12.0f)
+    {
+        const auto p = toScreen(db, db);
+        g.drawVerticalLine(juce::roundToInt(p.x), 0.0f, (float)getHeight());
+        g.drawHorizontalLine(juce::roundToInt(p.y), 0.0f, (float)getWidth());
+    }
+
+    // Hard knee, matching juce::dsp::Compressor.
+    const auto knee = juce::jlimit(minDb, maxDb, threshDb);
+    const auto outAtMax = knee + (maxDb - knee) / ratio;
+
+    juce::Path path;
+    path.startNewSubPath(toScreen(minDb, minDb));
+    path.lineTo(toScreen(knee, knee));
+    path.lineTo(toScreen(maxDb, outAtMax));
+
+    g.setColour(juce::Colours::white);
+    g.strokePath(path, juce::PathStrokeType(2.0f));
+
+    g.setColour(juce::Colours::black);
+    g.drawRect(0, 0, getWidth(), getHeight());
+}
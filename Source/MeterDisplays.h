@@ -0,0 +1,80 @@
+/*
+  ==============================================================================
+
+    MeterDisplays.h
+
+    Gain reduction history and transfer curve views for the editor. Both are
+    opaque and keep their expensive drawing in cached images, so a timer tick
+    only renders what actually changed.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "MeterFifo.h"
+
+//==============================================================================
+/** Sweeping history of input level (grey, from the bottom) and gain reduction
+    (orange, from the top). Each new frame is drawn as one column into a ring
+    buffered image that is shown as it is, with a cursor where the next column
+    goes, so a tick repaints only the columns it wrote and the cursor.
+*/
+class GainReductionHistory : public juce::Component
+{
+public:
+    GainReductionHistory();
+
+    void addFrames(const MeterFrame* frames, int numFrames);
+
+    void paint(juce::Graphics&) override;
+    void resized() override;
+
+    static constexpr float minLevelDb = -60.0f;
+    static constexpr float maxReductionDb = -24.0f;
+
+private:
+    void drawColumn(juce::Graphics& g, const MeterFrame& frame);
+    void repaintColumns(int firstX, int numColumns);
+
+    juce::Image history;
+    int writeX{ 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(GainReductionHistory)
+};
+
+//==============================================================================
+/** Static input/output curve of the compressor with a dot at the current
+    operating point. The curve is only re-rendered when thresh or ratio change;
+    moving the dot just repaints the two small areas it left and entered.
+*/
+class TransferCurveDisplay : public juce::Component
+{
+public:
+    TransferCurveDisplay();
+
+    void setCurve(float newThreshDb, float newRatio);
+    void setOperatingPoint(float inputDb, float gainReductionDb);
+
+    void paint(juce::Graphics&) override;
+    void resized() override;
+
+    static constexpr float minDb = -60.0f;
+    static constexpr float maxDb = 12.0f;
+
+private:
+    juce::Point<float> toScreen(float inDb, float outDb) const;
+    juce::Rectangle<int> getDotArea() const;
+    void renderCurve();
+
+    juce::Image curve;
+    float threshDb{ 0.0f };
+    float ratio{ 1.0f };
+    juce::Point<float> dot;
+    bool dotVisible{ false };
+
+    static constexpr float dotRadius = 4.0f;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TransferCurveDisplay)
+};
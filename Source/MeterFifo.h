@@ -0,0 +1,71 @@
+/*
+  ==============================================================================
+
+    MeterFifo.h
+
+    Lock-free single producer / single consumer queue used to hand level and
+    gain reduction summaries from the audio thread to the editor.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/** One history column: the detector input level and the gain reduction seen
+    over a fixed slice of time (see BasicCompAudioProcessor::meterFrameSeconds).
+*/
+struct MeterFrame
+{
+    float inputDb;
+    float gainReductionDb;
+};
+
+//==============================================================================
+class MeterFifo
+{
+public:
+    /** Audio thread. Frames are dropped (not blocked on) when the editor is
+        not keeping up.
+    */
+    void push(const MeterFrame& frame) noexcept
+    {
+        const auto scope = fifo.write(1);
+
+        if (scope.blockSize1 > 0)
+            frames[(size_t)scope.startIndex1] = frame;
+    }
+
+    /** Message thread. Copies up to maxFrames pending frames into dest and
+        returns how many were read.
+    */
+    int pop(MeterFrame* dest, int maxFrames) noexcept
+    {
+        const auto scope = fifo.read(juce::jmin(maxFrames, fifo.getNumReady()));
+
+        for (int i = 0; i < scope.blockSize1; ++i)
+            dest[i] = frames[(size_t)(scope.startIndex1 + i)];
+
+        for (int i = 0; i < scope.blockSize2; ++i)
+            dest[scope.blockSize1 + i] = frames[(size_t)(scope.startIndex2 + i)];
+
+        return scope.blockSize1 + scope.blockSize2;
+    }
+
+    /** Message thread. Drops every pending frame; unlike reset() this is safe
+        while the audio thread may be pushing.
+    */
+    void discardPending() noexcept { fifo.finishedRead(fifo.getNumReady()); }
+
+    void reset() noexcept { fifo.reset(); }
+
+    static constexpr int capacity = 512;
+
+private:
+    juce::AbstractFifo fifo{ capacity };
+    std::array<MeterFrame, capacity> frames{};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MeterFifo)
+};
@@ -0,0 +1,106 @@
+/*
+  ==============================================================================
+
+    ParameterEventQueue.h
+
+    Timestamped parameter changes on their way to the audio thread. Any
+    thread may push, including the audio thread itself when a host delivers
+    automation there; pushes only try the spin lock that serialises them, so
+    no pusher ever waits. A push that finds the lock taken or the queue full
+    marks its parameter dirty instead, and the owner resynchronises dirty
+    parameters from their current values. The audio thread pops everything
+    pending at the start of a block, sorted by sample offset, and splits the
+    block at those offsets.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+struct ParameterEvent
+{
+    int sampleOffset;   // into the next processed block
+    int parameter;      // owner defined index
+    float value;        // plain (not normalised) parameter value
+};
+
+//==============================================================================
+class ParameterEventQueue
+{
+public:
+    /** Any thread, wait-free for the caller. Returns false and marks the
+        parameter dirty when another thread is pushing or the audio thread
+        has fallen behind; the event's offset is lost then.
+    */
+    bool push(const ParameterEvent& event) noexcept
+    {
+        jassert(juce::isPositiveAndBelow(event.parameter, maxParameters));
+
+        const juce::SpinLock::ScopedTryLockType lock(writeLock);
+
+        if (lock.isLocked())
+        {
+            const auto scope = fifo.write(1);
+
+            if (scope.blockSize1 != 0)
+            {
+                events[(size_t)scope.startIndex1] = event;
+                return true;
+            }
+        }
+
+        dirtyParameters.fetch_or(1u << event.parameter);
+        return false;
+    }
+
+    /** Audio thread. Copies up to maxEvents pending events into dest, stably
+        sorted by sample offset, and returns how many were read.
+    */
+    int pop(ParameterEvent* dest, int maxEvents) noexcept
+    {
+        const auto scope = fifo.read(juce::jmin(maxEvents, fifo.getNumReady()));
+        const auto numEvents = scope.blockSize1 + scope.blockSize2;
+
+        for (int i = 0; i < scope.blockSize1; ++i)
+            dest[i] = events[(size_t)(scope.startIndex1 + i)];
+
+        for (int i = 0; i < scope.blockSize2; ++i)
+            dest[scope.blockSize1 + i] = events[(size_t)(scope.startIndex2 + i)];
+
+        // Insertion sort: events nearly always arrive in order, and it does not allocate.
+        for (int i = 1; i < numEvents; ++i)
+        {
+            const auto event = dest[i];
+            int j = i;
+
+            for (; j > 0 && dest[j - 1].sampleOffset > event.sampleOffset; --j)
+                dest[j] = dest[j - 1];
+
+            dest[j] = event;
+        }
+
+        return numEvents;
+    }
+
+    /** Audio thread. A bit per parameter whose push was dropped since the last
+        call; take it before pop(), since the current value of a dirty parameter
+        is at least as new as any of its events still queued.
+    */
+    juce::uint32 takeDirtyParameters() noexcept { return dirtyParameters.exchange(0); }
+
+    void reset() noexcept { fifo.reset(); }
+
+    static constexpr int capacity = 1024;
+    static constexpr int maxParameters = 32;
+
+private:
+    juce::AbstractFifo fifo{ capacity };
+    std::array<ParameterEvent, capacity> events{};
+    juce::SpinLock writeLock;
+    std::atomic<juce::uint32> dirtyParameters{ 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ParameterEventQueue)
+};
@@ -132,13 +132,140 @@ BasicCompAudioProcessorEditor::BasicCompAudioProcessorEditor(BasicCompAudioProce
     compOutputLabel.attachToComponent(&compOutput, false);
     outputAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(audioProcessor.treeState, "output", compOutput);
 
-    setSize(500, 600);
+
+    compMix.setLookAndFeel(&otherLookAndFeel);
+    compMix.setSliderStyle(juce::Slider::SliderStyle::RotaryHorizontalVerticalDrag);
+    compMix.setTextBoxStyle(juce::Slider::TextBoxBelow, false, small, 25);
+    compMix.setDoubleClickReturnValue(true, 100.0);
+    compMix.setTextValueSuffix(" %");
+    addAndMakeVisible(compMix);
+    addAndMakeVisible(compMixLabel);
+    compMixLabel.setText("Mix", juce::dontSendNotification);
+    compMixLabel.setJustificationType(juce::Justification::horizontallyCentred);
+    compMixLabel.setFont(juce::Font(20.0f, juce::Font::bold));
+    compMixLabel.setLookAndFeel(&otherLookAndFeel);
+    compMixLabel.attachToComponent(&compMix, false);
+    mixAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(audioProcessor.treeState, "mix", compMix);
+
+
+    compDrive.setLookAndFeel(&otherLookAndFeel);
+    compDrive.setSliderStyle(juce::Slider::SliderStyle::RotaryHorizontalVerticalDrag);
+    compDrive.setTextBoxStyle(juce::Slider::TextBoxBelow, false, small, 25);
+    compDrive.setDoubleClickReturnValue(true, 0.0);
+    compDrive.setTextValueSuffix(" dB");
+    addAndMakeVisible(compDrive);
+    addAndMakeVisible(compDriveLabel);
+    compDriveLabel.setText("Drive", juce::dontSendNotification);
+    compDriveLabel.setJustificationType(juce::Justification::horizontallyCentred);
+    compDriveLabel.setFont(juce::Font(20.0f, juce::Font::bold));
+    compDriveLabel.setLookAndFeel(&otherLookAndFeel);
+    compDriveLabel.attachToComponent(&compDrive, false);
+    driveAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(audioProcessor.treeState, "drive", compDrive);
+
+    // Items have to be there before the attachment selects one.
+    driveType.addItemList(audioProcessor.treeState.getParameter("driveType")->getAllValueStrings(), 1);
+    addAndMakeVisible(driveType);
+    driveTypeAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(audioProcessor.treeState, "driveType", driveType);
+
+    driveOversampling.setColour(juce::ToggleButton::textColourId, juce::Colours::black);
+    driveOversampling.setColour(juce::ToggleButton::tickColourId, juce::Colours::black);
+    addAndMakeVisible(driveOversampling);
+    driveOversamplingAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(audioProcessor.treeState, "driveOversampling", driveOversampling);
+
+#if BasicComp_RackStrips == 0
+    // Each capture goes to a new file in Documents/BasicComp Captures.
+    captureButton.setColour(juce::ToggleButton::textColourId, juce::Colours::black);
+    captureButton.setColour(juce::ToggleButton::tickColourId, juce::Colours::black);
+    addAndMakeVisible(captureButton);
+    captureButton.onClick = [this]
+    {
+        if (captureButton.getToggleState())
+        {
+            const auto folder = juce::File::getSpecialLocation(juce::File::userDocumentsDirectory).getChildFile("BasicComp Captures");
+            folder.createDirectory();
+            const auto file = folder.getNonexistentChildFile("capture " + juce::Time::getCurrentTime().formatted("%Y-%m-%d %H-%M-%S"), ".wav");
+
+            if (!audioProcessor.startCapture(file))
+                captureButton.setToggleState(false, juce::dontSendNotification);
+        }
+        else
+        {
+            audioProcessor.stopCapture();
+        }
+    };
+#endif
+
+    addAndMakeVisible(historyDisplay);
+    addAndMakeVisible(curveDisplay);
+#if BasicComp_RackStrips == 0
+    addAndMakeVisible(loudnessLabel);
+    loudnessLabel.setJustificationType(juce::Justification::centred);
+    loudnessLabel.setFont(juce::Font(15.0f, juce::Font::bold));
+    loudnessLabel.setColour(juce::Label::backgroundColourId, juce::Colour(40u, 40u, 40u));
+    loudnessLabel.setColour(juce::Label::textColourId, juce::Colours::white);
+#endif
+    audioProcessor.setMeteringEnabled(true);
+    startTimerHz(meterRefreshHz);
+
+    setSize(500, 860);
 }
 
 
 BasicCompAudioProcessorEditor::~BasicCompAudioProcessorEditor()
 {
+    stopTimer();
+    audioProcessor.setMeteringEnabled(false);
+}
+
+void BasicCompAudioProcessorEditor::timerCallback()
+{
+#if BasicComp_RackStrips == 0
+    // The loudness readout only needs a few updates a second.
+    if (++loudnessRefreshCounter >= meterRefreshHz / 5)
+    {
+        loudnessRefreshCounter = 0;
+
+        auto format = [](float value)
+        {
+            return std::isfinite(value) ? juce::String(value, 1) : juce::String("-inf");
+        };
+
+        const auto readings = audioProcessor.getLoudnessAnalyser().getReadings();
+        loudnessLabel.setText("M " + format(readings.momentaryLufs)
+                              + "   S " + format(readings.shortTermLufs)
+                              + "   I " + format(readings.integratedLufs) + " LUFS"
+                              + "   LRA " + format(readings.loudnessRangeLu) + " LU"
+                              + "   TP " + format(readings.truePeakDb) + " dBTP"
+                              + (readings.droppedSamples > 0 ? "   (" + juce::String(readings.droppedSamples) + " dropped)" : juce::String()),
+                              juce::dontSendNotification);
+        updateCaptureButton();
+    }
+#endif
+
+    curveDisplay.setCurve(audioProcessor.treeState.getRawParameterValue("thresh")->load(),
+                          audioProcessor.treeState.getRawParameterValue("ratio")->load());
+
+    const int numFrames = audioProcessor.getMeterFifo().pop(meterFrames.data(), (int)meterFrames.size());
+    if (numFrames == 0)
+        return;
+
+    historyDisplay.addFrames(meterFrames.data(), numFrames);
+
+    const auto& latest = meterFrames[(size_t)(numFrames - 1)];
+    curveDisplay.setOperatingPoint(latest.inputDb, latest.gainReductionDb);
+}
+
+#if BasicComp_RackStrips == 0
+void BasicCompAudioProcessorEditor::updateCaptureButton()
+{
+    // The processor ends a capture itself when the sample rate changes.
+    const auto& capture = audioProcessor.getSignalCapture();
+    captureButton.setToggleState(capture.isCapturing(), juce::dontSendNotification);
+
+    const auto dropped = capture.getNumDroppedSamples();
+    captureButton.setButtonText(dropped > 0 ? "Capture (" + juce::String(dropped) + " dropped)" : juce::String("Capture"));
 }
+#endif
 
 //==============================================================================
 void BasicCompAudioProcessorEditor::paint(juce::Graphics& g)
@@ -150,23 +277,44 @@ void BasicCompAudioProcessorEditor::paint(juce::Graphics& g)
 void BasicCompAudioProcessorEditor::resized()
 {
     float gapX{ (getWidth() - (small + small + big)) / 3 };
-    float gapY1{ (getHeight()-(small*3))/3 };
+    float gapY1{ (controlsHeight-(small*3))/3 };
 
 
-    panDial.setBounds((gapX*2.4 + small*2), (getHeight() / 3) - 100, big, big);
+    panDial.setBounds((gapX*2.4 + small*2), (controlsHeight / 3) - 100, big, big);
 
-    gainFader.setBounds((gapX*2.4 + small*2), (getHeight() / 3) + 125, big, 137);
+    gainFader.setBounds((gapX*2.4 + small*2), (controlsHeight / 3) + 125, big, 137);
 
     compInput.setBounds((gapX / 2), (small*.67), small, small+25);
 
-    compThresh.setBounds((gapX/2), (getHeight() / 3) + 25, small, small+25);
+    compThresh.setBounds((gapX/2), (controlsHeight / 3) + 25, small, small+25);
 
-    compRatio.setBounds((gapX/2), (getHeight() / 3) + 200, small, small+25);
+    compRatio.setBounds((gapX/2), (controlsHeight / 3) + 200, small, small+25);
 
     compAttack.setBounds(((getWidth() / 2) - small * 2 / 3), (small * .67), small, small+25);
 
-    compRelease.setBounds((getWidth() / 2) - small * 2 / 3, (getHeight() / 3) + 25, small, small+25);
+    compRelease.setBounds((getWidth() / 2) - small * 2 / 3, (controlsHeight / 3) + 25, small, small+25);
+
+    compOutput.setBounds((getWidth() / 2) - small * 2 / 3, (controlsHeight / 3) + 200, small, small+25);
+
+    compMix.setBounds((gapX*2.4 + small*2) + (big - small) / 2, (controlsHeight / 3) + 300, small, small+25);
+
+    compDrive.setBounds((gapX / 2), (controlsHeight / 3) + 325, small, small+25);
+
+    driveType.setBounds((getWidth() / 2) - small * 2 / 3 - 10, (controlsHeight / 3) + 340, small + 20, 24);
+
+    driveOversampling.setBounds((getWidth() / 2) - small * 2 / 3 - 10, (controlsHeight / 3) + 370, small + 20, 24);
+
+#if BasicComp_RackStrips == 0
+    captureButton.setBounds((getWidth() / 2) - small * 2 / 3 - 10, (controlsHeight / 3) + 400, small + 60, 24);
+#endif
 
-    compOutput.setBounds((getWidth() / 2) - small * 2 / 3, (getHeight() / 3) + 200, small, small+25);
+    auto meterArea = getLocalBounds().withTrimmedTop((int)controlsHeight).reduced(20, 10);
+#if BasicComp_RackStrips == 0
+    loudnessLabel.setBounds(meterArea.removeFromBottom(24));
+    meterArea.removeFromBottom(6);
+#endif
+    curveDisplay.setBounds(meterArea.removeFromRight(meterArea.getHeight()));
+    meterArea.removeFromRight(10);
+    historyDisplay.setBounds(meterArea);
 }
 
@@ -11,6 +11,7 @@
 
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
+#include "MeterDisplays.h"
 #include <cmath>
 #include <math.h>
 
@@ -56,7 +57,8 @@ public:
 
 };
 
-class BasicCompAudioProcessorEditor : public juce::AudioProcessorEditor
+class BasicCompAudioProcessorEditor : public juce::AudioProcessorEditor,
+    private juce::Timer
     //,public juce::Slider::Listener
 {
 public:
@@ -72,6 +74,8 @@ public:
 
 
 private:
+    void timerCallback() override;
+
     // This reference is provided as a quick way for your editor to
     // access the processor object that created it.
     BasicCompAudioProcessor& audioProcessor;
@@ -111,6 +115,33 @@ private:
     juce::Label compOutputLabel;
     std::unique_ptr<SliderAttachment> outputAttachment;
 
+    juce::Slider compMix;
+    juce::Label compMixLabel;
+    std::unique_ptr<SliderAttachment> mixAttachment;
+
+    juce::Slider compDrive;
+    juce::Label compDriveLabel;
+    std::unique_ptr<SliderAttachment> driveAttachment;
+    juce::ComboBox driveType;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> driveTypeAttachment;
+    juce::ToggleButton driveOversampling{ "2x" };
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> driveOversamplingAttachment;
+
+#if BasicComp_RackStrips == 0
+    juce::ToggleButton captureButton{ "Capture" };
+    void updateCaptureButton();
+#endif
+
+    GainReductionHistory historyDisplay;
+    TransferCurveDisplay curveDisplay;
+#if BasicComp_RackStrips == 0
+    juce::Label loudnessLabel;
+    int loudnessRefreshCounter{ 0 };
+#endif
+    std::array<MeterFrame, MeterFifo::capacity> meterFrames;
+    float controlsHeight{ 650 };
+    int meterRefreshHz{ 60 };
+
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(BasicCompAudioProcessorEditor)
 };
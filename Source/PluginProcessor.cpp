@@ -8,6 +8,16 @@
 
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
+#include "FastMath.h"
+
+static juce::AudioChannelSet getMainChannelSet()
+{
+#if BasicComp_RackStrips > 0
+    return juce::AudioChannelSet::discreteChannels(BasicComp_RackStrips);
+#else
+    return juce::AudioChannelSet::stereo();
+#endif
+}
 
 //==============================================================================
 BasicCompAudioProcessor::BasicCompAudioProcessor()
@@ -15,15 +25,21 @@ BasicCompAudioProcessor::BasicCompAudioProcessor()
                             : AudioProcessor(BusesProperties()
                         #if ! JucePlugin_IsMidiEffect
                         #if ! JucePlugin_IsSynth
-                                .withInput("Input", juce::AudioChannelSet::stereo(), true)
+                                .withInput("Input", getMainChannelSet(), true)
                         #endif
-                                .withOutput("Output", juce::AudioChannelSet::stereo(), true)
+                                .withOutput("Output", getMainChannelSet(), true)
                         #endif
                             )
 
                             , treeState(*this, nullptr, "PARAMETERS", createParameterLayout())
                         #endif
 {
+#if BasicComp_RackStrips > 0
+    // Rack strips are read straight from the tree once per block, so they need no listeners.
+    for (int strip = 0; strip < BasicComp_RackStrips; ++strip)
+        for (int i = 0; i < StripRack::numParameters; ++i)
+            stripParameters[(size_t)strip][(size_t)i] = treeState.getRawParameterValue(StripRack::parameterIds[i] + StripRack::getIdSuffix(strip));
+#else
     treeState.addParameterListener("input", this);
     treeState.addParameterListener("thresh", this);
     treeState.addParameterListener("ratio", this);
@@ -32,6 +48,22 @@ BasicCompAudioProcessor::BasicCompAudioProcessor()
     treeState.addParameterListener("output", this);
     treeState.addParameterListener("panner", this);
     treeState.addParameterListener("fader", this);
+    treeState.addParameterListener("mix", this);
+    treeState.addParameterListener("quality", this);
+    treeState.addParameterListener("drive", this);
+    treeState.addParameterListener("driveType", this);
+    treeState.addParameterListener("driveOversampling", this);
+    dryPreInput = treeState.getRawParameterValue("dryPreInput");
+
+    for (int i = 0; i < numAutomatedParameters; ++i)
+        automatedValues[(size_t)i] = treeState.getRawParameterValue(automatedParameterIds[i]);
+
+    stageOrder = treeState.getRawParameterValue("stageOrder");
+    for (int i = 0; i < numStages; ++i)
+        stageBypassParameters[(size_t)i] = treeState.getRawParameterValue(stageBypassIds[i]);
+
+    startTimer(latencyPollMilliseconds);
+#endif
 
 
 
@@ -39,6 +71,9 @@ BasicCompAudioProcessor::BasicCompAudioProcessor()
 
 BasicCompAudioProcessor::~BasicCompAudioProcessor()
 {
+    stopTimer();
+
+#if BasicComp_RackStrips == 0
     treeState.removeParameterListener("input", this);
     treeState.removeParameterListener("thresh", this);
     treeState.removeParameterListener("ratio", this);
@@ -47,10 +82,50 @@ BasicCompAudioProcessor::~BasicCompAudioProcessor()
     treeState.removeParameterListener("output", this);
     treeState.removeParameterListener("panner", this);
     treeState.removeParameterListener("fader", this);
+    treeState.removeParameterListener("mix", this);
+    treeState.removeParameterListener("quality", this);
+    treeState.removeParameterListener("drive", this);
+    treeState.removeParameterListener("driveType", this);
+    treeState.removeParameterListener("driveOversampling", this);
+#endif
 
 }
 
 juce::AudioProcessorValueTreeState::ParameterLayout BasicCompAudioProcessor::createParameterLayout()
+{
+#if BasicComp_RackStrips > 0
+    juce::AudioProcessorValueTreeState::ParameterLayout layout;
+
+    for (int strip = 0; strip < BasicComp_RackStrips; ++strip)
+    {
+        const auto number = juce::String(strip + 1);
+        auto group = std::make_unique<juce::AudioProcessorParameterGroup>("strip" + number, "Strip " + number, " | ");
+
+        for (auto& param : createStripParameters(StripRack::getIdSuffix(strip), false))
+            group->addChild(std::move(param));
+
+        layout.add(std::move(group));
+    }
+
+    return layout;
+#else
+    auto params = createStripParameters({}, true);
+    params.push_back(std::make_unique<juce::AudioParameterFloat>("mix", "Mix", 0.0f, 100.0f, 100.0f));
+    params.push_back(std::make_unique<juce::AudioParameterBool>("dryPreInput", "Dry Pre-Input", false));
+    params.push_back(std::make_unique<juce::AudioParameterChoice>("quality", "Quality", juce::StringArray{ "Full", "Eco x4", "Eco x8", "Eco x16", "Eco x16 Summary" }, 0));
+    params.push_back(std::make_unique<juce::AudioParameterFloat>("drive", "Drive", 0.0f, 24.0f, 0.0f));
+    params.push_back(std::make_unique<juce::AudioParameterChoice>("driveType", "Drive Type", juce::StringArray{ "Off", "Tanh", "Tube", "Hard Clip" }, 0));
+    params.push_back(std::make_unique<juce::AudioParameterBool>("driveOversampling", "Drive 2x Oversampling", false));
+    params.push_back(std::make_unique<juce::AudioParameterChoice>("stageOrder", "Stage Order", juce::StringArray{ "Standard", "Pan First", "Pre-Fader" }, 0));
+
+    const char* stageNames[] = { "Input", "Compressor", "Output", "Panner", "Fader" };
+    for (int i = 0; i < numStages; ++i)
+        params.push_back(std::make_unique<juce::AudioParameterBool>(stageBypassIds[i], juce::String(stageNames[i]) + " Bypass", false));
+    return { params.begin(), params.end() };
+#endif
+}
+
+std::vector<std::unique_ptr<juce::RangedAudioParameter>> BasicCompAudioProcessor::createStripParameters(const juce::String& idSuffix, bool withPanner)
 {
     std::vector <std::unique_ptr<juce::RangedAudioParameter>> params;
 
@@ -59,14 +134,13 @@ juce::AudioProcessorValueTreeState::ParameterLayout BasicCompAudioProcessor::cre
     juce::NormalisableRange<float> attackRange = juce::NormalisableRange<float>(0.01f, 100.0f, 0.1f);
     attackRange.setSkewForCentre(5.0f);
 
-    auto pInput = std::make_unique<juce::AudioParameterFloat>("input", "Input", -60.0f, 10.0f, 0.0f);
-    auto pThresh = std::make_unique<juce::AudioParameterFloat>("thresh", "Thresh", -60.0f, 10.0f, 0.0f);
-    auto pRatio = std::make_unique<juce::AudioParameterFloat>("ratio", "Ratio", 1.0f, 20.0f, 1.0f);
-    auto pAttack = std::make_unique<juce::AudioParameterFloat>("attack", "Attack", attackRange, 10.0f);
-    auto pRelease = std::make_unique<juce::AudioParameterFloat>("release", "Release", releaseRange, 125.0f);
-    auto pOutput = std::make_unique<juce::AudioParameterFloat>("output", "Output", 0.0f, 60.0f, 0.0f);
-    auto pPanner = std::make_unique<juce::AudioParameterFloat>("panner", "Panner", -1.0f, 1.0f, 0.0f);
-    auto pFader = std::make_unique<juce::AudioParameterFloat>("fader", "Fader", -90.0f, 10.0f, 0.0f);
+    auto pInput = std::make_unique<juce::AudioParameterFloat>("input" + idSuffix, "Input", -60.0f, 10.0f, 0.0f);
+    auto pThresh = std::make_unique<juce::AudioParameterFloat>("thresh" + idSuffix, "Thresh", -60.0f, 10.0f, 0.0f);
+    auto pRatio = std::make_unique<juce::AudioParameterFloat>("ratio" + idSuffix, "Ratio", 1.0f, 20.0f, 1.0f);
+    auto pAttack = std::make_unique<juce::AudioParameterFloat>("attack" + idSuffix, "Attack", attackRange, 10.0f);
+    auto pRelease = std::make_unique<juce::AudioParameterFloat>("release" + idSuffix, "Release", releaseRange, 125.0f);
+    auto pOutput = std::make_unique<juce::AudioParameterFloat>("output" + idSuffix, "Output", 0.0f, 60.0f, 0.0f);
+    auto pFader = std::make_unique<juce::AudioParameterFloat>("fader" + idSuffix, "Fader", -90.0f, 10.0f, 0.0f);
 
 
     params.push_back(std::move(pInput));
@@ -75,31 +149,140 @@ juce::AudioProcessorValueTreeState::ParameterLayout BasicCompAudioProcessor::cre
     params.push_back(std::move(pAttack));
     params.push_back(std::move(pRelease));
     params.push_back(std::move(pOutput));
-    params.push_back(std::move(pPanner));
+    if (withPanner)
+        params.push_back(std::make_unique<juce::AudioParameterFloat>("panner" + idSuffix, "Panner", -1.0f, 1.0f, 0.0f));
     params.push_back(std::move(pFader));
 
 
 
-    return { params.begin(), params.end() };
+    return params;
 }
 
 void BasicCompAudioProcessor::parameterChanged(const juce::String& parameterID, float newValue)
 {
-    updateParameters();
+#if BasicComp_RackStrips == 0
+    // Continuous parameters go through the event queue to the audio thread;
+    // the rest are mode switches that the modules pick up atomically.
+    for (int i = 0; i < numAutomatedParameters; ++i)
+    {
+        if (parameterID == automatedParameterIds[i])
+        {
+            pushParameterEvent(0, i, newValue);
+            return;
+        }
+    }
+
+    updateModes();
+
+    // Only the drive settings change the latency. Hosts expect it reported on
+    // the message thread, but automation may arrive on the audio thread, which
+    // must not post messages, so that case is left for timerCallback().
+    if (parameterID == "driveType" || parameterID == "driveOversampling")
+    {
+        if (juce::MessageManager::existsAndIsCurrentThread())
+            setLatencySamples(driveModule.getLatencySamples());
+        else
+            latencyChangePending.store(true);
+    }
+#else
+    juce::ignoreUnused(parameterID, newValue);
+#endif
+}
+
+void BasicCompAudioProcessor::timerCallback()
+{
+#if BasicComp_RackStrips == 0
+    if (latencyChangePending.exchange(false))
+        setLatencySamples(driveModule.getLatencySamples());
+#endif
+}
+
+#if BasicComp_RackStrips == 0
+bool BasicCompAudioProcessor::pushParameterEvent(int sampleOffset, int parameterIndex, float value) noexcept
+{
+    jassert(juce::isPositiveAndBelow(parameterIndex, numAutomatedParameters));
+    return parameterEvents.push({ juce::jmax(0, sampleOffset), parameterIndex, value });
+}
+
+void BasicCompAudioProcessor::applyParameter(int parameterIndex, float value) noexcept
+{
+    // Indices follow automatedParameterIds.
+    switch (parameterIndex)
+    {
+        case 0: inputModule.setGainDecibels(value); break;
+        case 1: compressorModule.setThreshold(value); break;
+        case 2: compressorModule.setRatio(value); break;
+        case 3: compressorModule.setAttack(value); break;
+        case 4: compressorModule.setRelease(value); break;
+        case 5: outputModule.setGainDecibels(value); break;
+        case 6: pannerModule.setPan(value); break;
+        case 7: faderModule.setGainDecibels(value); break;
+        case 8: mixSmoother.setTargetValue(value / 100.0f); break;
+        case 9: driveModule.setDriveDecibels(value); break;
+        default: jassertfalse; break;
+    }
 }
 
 void BasicCompAudioProcessor::updateParameters()
 {
-    inputModule.setGainDecibels(treeState.getRawParameterValue("input")->load());
-    compressorModule.setThreshold(treeState.getRawParameterValue("thresh")->load());
-    compressorModule.setRatio(treeState.getRawParameterValue("ratio")->load());
-    compressorModule.setAttack(treeState.getRawParameterValue("attack")->load());
-    compressorModule.setRelease(treeState.getRawParameterValue("release")->load());
-    outputModule.setGainDecibels(treeState.getRawParameterValue("output")->load());
-    pannerModule.setPan(treeState.getRawParameterValue("panner")->load());
-    faderModule.setGainDecibels(treeState.getRawParameterValue("fader")->load());
+    // Only while the audio thread is not running, i.e. from prepareToPlay.
+    for (int i = 0; i < numAutomatedParameters; ++i)
+        applyParameter(i, automatedValues[(size_t)i]->load());
+
+    updateModes();
 }
 
+void BasicCompAudioProcessor::updateModes()
+{
+    // Eco modes run the compressor's gain computer once every 4, 8 or 16 samples;
+    // the last one, appended so saved choices keep their meaning, also runs the
+    // detector once per 16 samples.
+    const auto quality = (int)treeState.getRawParameterValue("quality")->load();
+    const auto summary = quality == 4;
+    compressorModule.setControlInterval(quality == 0 ? 1 : summary ? 16 : 2 << quality);
+    compressorModule.setSummaryDetector(summary);
+
+    driveModule.setCurve((DriveStage::Curve)(int)treeState.getRawParameterValue("driveType")->load());
+    driveModule.setOversampling(treeState.getRawParameterValue("driveOversampling")->load() >= 0.5f);
+}
+#endif
+
+#if BasicComp_RackStrips > 0
+void BasicCompAudioProcessor::updateRackParameters() noexcept
+{
+    for (int strip = 0; strip < BasicComp_RackStrips; ++strip)
+    {
+        const auto& p = stripParameters[(size_t)strip];
+        rack.setStrip(strip, { p[0]->load(), p[1]->load(), p[2]->load(), p[3]->load(),
+                               p[4]->load(), p[5]->load(), p[6]->load() });
+    }
+}
+
+juce::ValueTree BasicCompAudioProcessor::getStripState(int strip) const
+{
+    juce::ValueTree state("STRIP");
+
+    for (int i = 0; i < StripRack::numParameters; ++i)
+        state.setProperty(StripRack::parameterIds[i], stripParameters[(size_t)strip][(size_t)i]->load(), nullptr);
+
+    return state;
+}
+
+void BasicCompAudioProcessor::setStripState(int strip, const juce::ValueTree& state)
+{
+    for (int i = 0; i < StripRack::numParameters; ++i)
+    {
+        const juce::Identifier property(StripRack::parameterIds[i]);
+
+        if (!state.hasProperty(property))
+            continue;
+
+        if (auto* param = treeState.getParameter(StripRack::parameterIds[i] + StripRack::getIdSuffix(strip)))
+            param->setValueNotifyingHost(param->convertTo0to1((float)state.getProperty(property)));
+    }
+}
+#endif
+
 //==============================================================================
 const juce::String BasicCompAudioProcessor::getName() const
 {
@@ -165,6 +348,11 @@ void BasicCompAudioProcessor::changeProgramName(int index, const juce::String& n
 //==============================================================================
 void BasicCompAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
+#if BasicComp_RackStrips > 0
+    juce::ignoreUnused(samplesPerBlock);
+    rack.prepare(sampleRate, BasicComp_RackStrips);
+    updateRackParameters();
+#else
     juce::dsp::ProcessSpec spec;
     spec.maximumBlockSize = samplesPerBlock;
     spec.sampleRate = sampleRate;
@@ -175,14 +363,50 @@ void BasicCompAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlo
     outputModule.prepare(spec);
     outputModule.setRampDurationSeconds(0.01f);
     compressorModule.prepare(spec);
+    driveModule.prepare(spec);
     pannerModule.prepare(spec);
     //*Set the Panner Rule
     //pannerModule.setRule(juce::dsp::PannerRule::squareRoot3dB);
     faderModule.prepare(spec);
     faderModule.setRampDurationSeconds(0.01f);
 
+    meterSamplesPerFrame = juce::jmax(1, juce::roundToInt(sampleRate * meterFrameSeconds));
+    restartMeterFrame();
+
+    loudnessAnalyser.prepare(sampleRate, getTotalNumOutputChannels(), samplesPerBlock);
+
+    dryBuffer.setSize((int)spec.numChannels, samplesPerBlock);
+    dryDelay.prepare(spec);
+    dryDelay.setMaximumDelayInSamples(juce::jmax(1, driveModule.getMaximumLatencySamples()));
+    updateDryDelay();
+    dryPathActive = false;
+    mixSmoother.reset(sampleRate, 0.02);
+    mixSmoother.setCurrentAndTargetValue(treeState.getRawParameterValue("mix")->load() / 100.0f);
+
+    // Allocated whether or not a capture is running, so starting one never allocates on the audio thread.
+    captureBuffer.setSize(numCaptureSignals * (int)spec.numChannels, samplesPerBlock);
+    meterDetectorBuffer.setSize(2 * (int)spec.numChannels, samplesPerBlock);
+    if (signalCapture.isCapturing() && sampleRate != captureSampleRate)
+        signalCapture.stop();
+
     updateParameters();
+    setLatencySamples(driveModule.getLatencySamples());
+
+    // Parameters applied here take effect from the first sample, like events
+    // at offset 0, instead of ramping up from unity after every prepare.
+    inputModule.reset();
+    outputModule.reset();
+    faderModule.reset();
+#endif
+}
 
+void BasicCompAudioProcessor::setMeteringEnabled(bool shouldBeEnabled) noexcept
+{
+    // Read side of the FIFO, so this is safe while the audio thread pushes.
+    if (shouldBeEnabled)
+        meterFifo.discardPending();
+
+    meteringEnabled.store(shouldBeEnabled);
 }
 
 void BasicCompAudioProcessor::releaseResources()
@@ -202,9 +426,14 @@ bool BasicCompAudioProcessor::isBusesLayoutSupported(const BusesLayout& layouts)
     // In this template code we only support mono or stereo.
     // Some plugin hosts, such as certain GarageBand versions, will only
     // load plugins that support stereo bus layouts.
+#if BasicComp_RackStrips > 0
+    if (layouts.getMainOutputChannelSet() != getMainChannelSet())
+        return false;
+#else
     if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
         && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
         return false;
+#endif
 
     // This checks if the input layout matches the output layout
 #if ! JucePlugin_IsSynth
@@ -223,14 +452,316 @@ void BasicCompAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juc
     auto totalNumInputChannels = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
 
-    juce::dsp::AudioBlock<float> block{ buffer };
-    inputModule.process(juce::dsp::ProcessContextReplacing<float>(block));
-    compressorModule.process(juce::dsp::ProcessContextReplacing<float>(block));
-    outputModule.process(juce::dsp::ProcessContextReplacing<float>(block));
-    pannerModule.process(juce::dsp::ProcessContextReplacing<float>(block));
-    faderModule.process(juce::dsp::ProcessContextReplacing<float>(block));
+#if BasicComp_RackStrips > 0
+    updateRackParameters();
+    rack.process(buffer);
+#else
+    const int numSamples = buffer.getNumSamples();
+
+    stageChain = stageChains[(size_t)juce::jlimit(0, numStageOrders - 1, (int)stageOrder->load())];
+    for (int i = 0; i < numStages; ++i)
+        stageBypassed[(size_t)i] = stageBypassParameters[(size_t)i]->load() >= 0.5f;
+
+    capturingBlock = signalCapture.isCapturing()
+                  && captureBuffer.getNumChannels() == numCaptureSignals * buffer.getNumChannels()
+                  && numSamples <= captureBuffer.getNumSamples();
+
+    // A dropped event means the DSP may have missed a change to its parameter:
+    // take the tree's value, which is at least as new, and skip its queued events.
+    const auto dirtyParameters = parameterEvents.takeDirtyParameters();
+    int numEvents = parameterEvents.pop(blockEvents.data(), (int)blockEvents.size());
+
+    if (dirtyParameters != 0)
+    {
+        for (int i = 0; i < numAutomatedParameters; ++i)
+            if ((dirtyParameters & (1u << i)) != 0)
+                applyParameter(i, automatedValues[(size_t)i]->load());
+
+        numEvents = (int)(std::remove_if(blockEvents.begin(), blockEvents.begin() + numEvents,
+                                         [dirtyParameters](const ParameterEvent& e) { return (dirtyParameters & (1u << e.parameter)) != 0; })
+                          - blockEvents.begin());
+    }
+
+    int event = 0;
+
+    for (int start = 0; start < numSamples;)
+    {
+        for (; event < numEvents && blockEvents[(size_t)event].sampleOffset <= start; ++event)
+            applyParameter(blockEvents[(size_t)event].parameter, blockEvents[(size_t)event].value);
+
+        const int end = event < numEvents ? juce::jmin(numSamples, blockEvents[(size_t)event].sampleOffset) : numSamples;
+        processRange(buffer, start, end - start);
+        start = end;
+    }
+
+    for (; event < numEvents; ++event)
+        applyParameter(blockEvents[(size_t)event].parameter, blockEvents[(size_t)event].value);
+
+    if (capturingBlock)
+        writeCapture(numSamples);
+
+    loudnessAnalyser.pushBlock(buffer, isNonRealtime());
+#endif
+}
+
+#if BasicComp_RackStrips == 0
+void BasicCompAudioProcessor::processRange(juce::AudioBuffer<float>& buffer, int startSample, int numSamples) noexcept
+{
+    StageRange range;
+    range.block = juce::dsp::AudioBlock<float>(buffer).getSubBlock((size_t)startSample, (size_t)numSamples);
+    range.dryBlock = juce::dsp::AudioBlock<float>(dryBuffer).getSubsetChannelBlock(0, range.block.getNumChannels())
+                                                            .getSubBlock((size_t)startSample, (size_t)numSamples);
+    range.startSample = startSample;
+    range.metering = meteringEnabled.load(std::memory_order_relaxed);
+
+    // A frame half summed before the last editor closed is not the new one's.
+    if (range.metering && !meteringWasEnabled)
+        restartMeterFrame();
+    meteringWasEnabled = range.metering;
+    range.dryNeeded = mixSmoother.isSmoothing() || mixSmoother.getTargetValue() < 1.0f;
+    range.dryTappedAtCompressor = range.dryNeeded && dryPreInput->load() < 0.5f;
+    range.dryHoldsCompressorInput = false;
+
+    if (range.dryNeeded && !dryPathActive)
+        dryDelay.reset();
+    dryPathActive = range.dryNeeded;
+
+    (this->*stageChain)(range);
+
+    if (capturingBlock)
+        getCaptureBlock(captureOutput, startSample, numSamples).copyFrom(range.block);
+}
+
+template <BasicCompAudioProcessor::Stage stage, BasicCompAudioProcessor::Stage... rest>
+void BasicCompAudioProcessor::processStages(StageRange& range) noexcept
+{
+    constexpr Stage next[] = { rest..., numStages };
+    processStage<stage, next[0] == compressorStage>(range);
+
+    if constexpr (sizeof...(rest) > 0)
+        processStages<rest...>(range);
+}
+
+template <BasicCompAudioProcessor::Stage stage, bool feedsCompressor>
+void BasicCompAudioProcessor::processStage(StageRange& range) noexcept
+{
+    // Bypass goes through the context, which every module already honours.
+    juce::dsp::ProcessContextReplacing<float> context(range.block);
+    context.isBypassed = stageBypassed[stage];
+
+    if constexpr (stage == inputStage)
+    {
+        if (range.dryNeeded && !range.dryTappedAtCompressor)
+            range.dryBlock.copyFrom(range.block);
+
+        if constexpr (feedsCompressor)
+        {
+            // Input gain writes into the dry buffer and the compressor reads it
+            // back from there into the main buffer, so tapping costs no copy.
+            if (range.dryTappedAtCompressor)
+            {
+                juce::dsp::ProcessContextNonReplacing<float> intoDry(range.block, range.dryBlock);
+                intoDry.isBypassed = context.isBypassed;
+                inputModule.process(intoDry);
+                range.dryHoldsCompressorInput = true;
+                return;
+            }
+        }
+
+        inputModule.process(context);
+    }
+    else if constexpr (stage == compressorStage)
+    {
+        processCompressorStage(range);
+    }
+    else if constexpr (stage == outputStage)
+    {
+        outputModule.process(context);
+
+        if (range.dryNeeded)
+        {
+            if (dryDelaySamples > 0)
+                dryDelay.process(juce::dsp::ProcessContextReplacing<float>(range.dryBlock));
+            mixDrySignal(range.block, range.dryBlock);
+        }
+    }
+    else if constexpr (stage == pannerStage)
+    {
+        pannerModule.process(context);
+    }
+    else
+    {
+        static_assert(stage == faderStage);
+        faderModule.process(context);
+    }
+}
+
+void BasicCompAudioProcessor::processCompressorStage(StageRange& range) noexcept
+{
+    auto& block = range.block;
+    const auto startSample = range.startSample;
+    const auto numSamples = (int)block.getNumSamples();
+
+    // Metering reads the detector through the same tap as a capture, into
+    // the capture buffer when one is running and the meter buffer otherwise.
+    ControlRateCompressor::DetectorTap detectorTap;
+    if (capturingBlock)
+        detectorTap = { getCaptureBlock(captureEnvelope, startSample, numSamples),
+                        getCaptureBlock(captureGainReduction, startSample, numSamples) };
+    else if (range.metering)
+        detectorTap = { getMeterDetectorBlock(0, startSample, numSamples),
+                        getMeterDetectorBlock(1, startSample, numSamples) };
+    const auto* tap = capturingBlock || range.metering ? &detectorTap : nullptr;
+
+    if (range.dryTappedAtCompressor && !range.dryHoldsCompressorInput)
+    {
+        range.dryBlock.copyFrom(block);
+        range.dryHoldsCompressorInput = true;
+    }
+
+    if (range.dryHoldsCompressorInput)
+    {
+        if (capturingBlock)
+            getCaptureBlock(captureInput, startSample, numSamples).copyFrom(range.dryBlock);
+
+        juce::dsp::ProcessContextNonReplacing<float> context(range.dryBlock, block);
+        context.isBypassed = stageBypassed[compressorStage];
+        compressorModule.process(context, tap);
+    }
+    else
+    {
+        if (capturingBlock)
+            getCaptureBlock(captureInput, startSample, numSamples).copyFrom(block);
+
+        juce::dsp::ProcessContextReplacing<float> context(block);
+        context.isBypassed = stageBypassed[compressorStage];
+        compressorModule.process(context, tap);
+    }
+
+    if (range.metering)
+        pushMeterData(detectorTap, numSamples);
+
+    // The drive has its own Off, so it keeps running when only the compressor is bypassed.
+    driveModule.process(juce::dsp::ProcessContextReplacing<float>(block));
+    if (driveModule.getProcessedLatencySamples() != dryDelaySamples)
+        updateDryDelay();
 }
 
+// Indexed by the "stageOrder" choice. The input stage, where the pre-input
+// dry tap sits, always directly precedes the compressor and the output stage,
+// which mixes the dry signal back in, directly follows it, so the dry path
+// shares every other stage in each order. Input gain, pan and fader commute,
+// so keeping the input stage last before the compressor changes no order.
+const std::array<BasicCompAudioProcessor::StageChain, BasicCompAudioProcessor::numStageOrders> BasicCompAudioProcessor::stageChains
+{
+    &BasicCompAudioProcessor::processStages<inputStage, compressorStage, outputStage, pannerStage, faderStage>,
+    &BasicCompAudioProcessor::processStages<pannerStage, inputStage, compressorStage, outputStage, faderStage>,
+    &BasicCompAudioProcessor::processStages<faderStage, inputStage, compressorStage, outputStage, pannerStage>
+};
+
+bool BasicCompAudioProcessor::startCapture(const juce::File& file)
+{
+    captureSampleRate = getSampleRate();
+    return signalCapture.start(file, captureSampleRate, numCaptureSignals * getTotalNumOutputChannels());
+}
+
+juce::dsp::AudioBlock<float> BasicCompAudioProcessor::getCaptureBlock(CaptureSignal signal, int startSample, int numSamples) noexcept
+{
+    const auto channelsPerSignal = (size_t)(captureBuffer.getNumChannels() / numCaptureSignals);
+    return juce::dsp::AudioBlock<float>(captureBuffer).getSubsetChannelBlock((size_t)signal * channelsPerSignal, channelsPerSignal)
+                                                      .getSubBlock((size_t)startSample, (size_t)numSamples);
+}
+
+juce::dsp::AudioBlock<float> BasicCompAudioProcessor::getMeterDetectorBlock(int signal, int startSample, int numSamples) noexcept
+{
+    // Envelope channels first, then gain.
+    const auto channelsPerSignal = (size_t)(meterDetectorBuffer.getNumChannels() / 2);
+    return juce::dsp::AudioBlock<float>(meterDetectorBuffer).getSubsetChannelBlock((size_t)signal * channelsPerSignal, channelsPerSignal)
+                                                            .getSubBlock((size_t)startSample, (size_t)numSamples);
+}
+
+void BasicCompAudioProcessor::writeCapture(int numSamples) noexcept
+{
+    // The detector tap holds linear gain; 20 log10(g) = 6.0206 log2(g).
+    const auto channelsPerSignal = captureBuffer.getNumChannels() / numCaptureSignals;
+
+    for (int channel = 0; channel < channelsPerSignal; ++channel)
+    {
+        auto* gain = captureBuffer.getWritePointer(captureGainReduction * channelsPerSignal + channel);
+
+        for (int i = 0; i < numSamples; ++i)
+            gain[i] = 6.02059991f * FastMath::log2(gain[i]);
+    }
+
+    signalCapture.write(captureBuffer.getArrayOfReadPointers(), numSamples);
+}
+
+void BasicCompAudioProcessor::updateDryDelay()
+{
+    // The dry path has to line up with the latency the wet path actually ran
+    // with; this is called from the audio thread, so the delay line is
+    // already sized for the most the drive stage can add.
+    dryDelaySamples = driveModule.getProcessedLatencySamples();
+    dryDelay.setDelay((float)dryDelaySamples);
+    dryDelay.reset();
+}
+
+void BasicCompAudioProcessor::mixDrySignal(juce::dsp::AudioBlock<float>& wetBlock, const juce::dsp::AudioBlock<float>& dry) noexcept
+{
+    if (!mixSmoother.isSmoothing())
+    {
+        const auto mix = mixSmoother.getCurrentValue();
+        wetBlock.multiplyBy(mix);
+        wetBlock.addProductOf(dry, 1.0f - mix);
+        return;
+    }
+
+    const auto numChannels = wetBlock.getNumChannels();
+
+    for (size_t i = 0; i < wetBlock.getNumSamples(); ++i)
+    {
+        const auto mix = mixSmoother.getNextValue();
+
+        for (size_t ch = 0; ch < numChannels; ++ch)
+            wetBlock.setSample((int)ch, (int)i, wetBlock.getSample((int)ch, (int)i) * mix + dry.getSample((int)ch, (int)i) * (1.0f - mix));
+    }
+}
+
+void BasicCompAudioProcessor::restartMeterFrame() noexcept
+{
+    meterSamplesPending = 0;
+    meterInputPeak = 0.0f;
+    meterGainReductionDb = 0.0f;
+}
+
+void BasicCompAudioProcessor::pushMeterData(const ControlRateCompressor::DetectorTap& detector, int numSamples) noexcept
+{
+    // The highest envelope and the lowest gain the detector produced inside
+    // each frame are what gets shown. A bypassed compressor leaves an empty
+    // envelope and unity gain, so the meters go idle with it.
+    meterInputPeak = juce::jmax(meterInputPeak, detector.envelope.findMinAndMax().getEnd());
+    meterGainReductionDb = juce::jmin(meterGainReductionDb,
+                                      juce::Decibels::gainToDecibels(detector.gain.findMinAndMax().getStart()));
+
+    meterSamplesPending += numSamples;
+
+    if (meterSamplesPending < meterSamplesPerFrame)
+        return;
+
+    // Blocks longer than a frame repeat the summary so the history keeps scrolling in real time.
+    const MeterFrame frame{ juce::Decibels::gainToDecibels(meterInputPeak), meterGainReductionDb };
+
+    while (meterSamplesPending >= meterSamplesPerFrame)
+    {
+        meterFifo.push(frame);
+        meterSamplesPending -= meterSamplesPerFrame;
+    }
+
+    meterInputPeak = 0.0f;
+    meterGainReductionDb = 0.0f;
+}
+#endif
+
 //==============================================================================
 bool BasicCompAudioProcessor::hasEditor() const
 {
@@ -239,8 +770,12 @@ bool BasicCompAudioProcessor::hasEditor() const
 
 juce::AudioProcessorEditor* BasicCompAudioProcessor::createEditor()
 {
+#if BasicComp_RackStrips > 0
+    return new juce::GenericAudioProcessorEditor(*this);
+#else
     return new BasicCompAudioProcessorEditor(*this);
     //return new juce::GenericAudioProcessorEditor(*this);
+#endif
 }
 
 //==============================================================================
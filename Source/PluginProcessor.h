@@ -9,12 +9,35 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "MeterFifo.h"
+#include "ParameterEventQueue.h"
+#include "BackgroundThread.h"
+#include "LoudnessAnalyser.h"
+#include "SignalCapture.h"
+#include "StripRack.h"
+#include "ControlRateCompressor.h"
+#include "DriveStage.h"
+
+// Set BasicComp_RackStrips (Projucer: Preprocessor Definitions) to a strip count
+// to build the rack variant: one instance hosting that many independent mono
+// strips on a discrete multichannel bus, instead of the single stereo strip.
+#ifndef BasicComp_RackStrips
+ #define BasicComp_RackStrips 0
+#endif
+
+// Set BasicComp_Diagnostics=1 to compile the diagnostic harnesses; plugin
+// builds leave them out. Diagnostics/BasicCompDiagnostics.jucer is the
+// console project that builds and runs them.
+#ifndef BasicComp_Diagnostics
+ #define BasicComp_Diagnostics 0
+#endif
 
 //==============================================================================
 /**
 */
 class BasicCompAudioProcessor : public juce::AudioProcessor,
-    public juce::AudioProcessorValueTreeState::Listener
+    public juce::AudioProcessorValueTreeState::Listener,
+    private juce::Timer
 
 {
 public:
@@ -62,19 +85,165 @@ public:
 
     double cInput;
 
+    //==============================================================================
+    // Metering for the editor's history and transfer curve displays. Nothing is
+    // measured unless an editor has switched it on.
+    static constexpr double meterFrameSeconds = 0.02;
+    MeterFifo& getMeterFifo() noexcept { return meterFifo; }
+    /** Message thread, by the editor that reads the FIFO. Switching on drops
+        whatever a previous editor left queued.
+    */
+    void setMeteringEnabled(bool shouldBeEnabled) noexcept;
+
+#if BasicComp_RackStrips == 0
+    // Loudness and true peak of the output, for the editor and for offline
+    // renders (resetStatistics() before, waitUntilAnalysed() after).
+    LoudnessAnalyser& getLoudnessAnalyser() noexcept { return loudnessAnalyser; }
+
+    //==============================================================================
+    // Sample-accurate automation. Continuous parameters reach the DSP only as
+    // events, and processBlock splits each block at their offsets, so every
+    // range between two events runs with constant (or ramping) settings.
+    // parameterChanged() queues at offset 0 of the next block; a format
+    // wrapper that knows where in the block a point lands can queue it there.
+    static constexpr const char* automatedParameterIds[] = { "input", "thresh", "ratio", "attack", "release",
+                                                             "output", "panner", "fader", "mix", "drive" };
+    static constexpr int numAutomatedParameters = (int)std::size(automatedParameterIds);
+    static_assert(numAutomatedParameters <= ParameterEventQueue::maxParameters, "dirty flags are one bit per parameter");
+
+    //==============================================================================
+    // Stage order ("stageOrder": Standard, Pan First, Pre-Fader) and per-stage
+    // bypass, both latched once per block. Each order is compiled into its own
+    // chain and picked from a table, so neither costs anything per sample.
+    enum Stage { inputStage, compressorStage, outputStage, pannerStage, faderStage, numStages };
+    static constexpr const char* stageBypassIds[] = { "inputBypass", "compBypass", "outputBypass", "pannerBypass", "faderBypass" };
+    static constexpr int numStageOrders = 3;
+
+    /** Any thread. parameterIndex indexes automatedParameterIds, value is the
+        plain parameter value; offsets past the end of the block apply after it.
+        False if the event was dropped: the parameter then takes its current
+        value at the start of the next block.
+    */
+    bool pushParameterEvent(int sampleOffset, int parameterIndex, float value) noexcept;
+
+    //==============================================================================
+    // Capture to a float WAV of what the compressor saw and did: its input,
+    // detector envelope (linear) and gain reduction (dB), then the plugin's
+    // output, one group of channels each in that order. Message thread;
+    // false if the file could not be created. A sample rate change ends it.
+    bool startCapture(const juce::File& file);
+    void stopCapture() { signalCapture.stop(); }
+    const SignalCapture& getSignalCapture() const noexcept { return signalCapture; }
+#endif
+
+#if BasicComp_RackStrips > 0
+    //==============================================================================
+    // Copy one strip's settings to or from another strip, session or instance.
+    juce::ValueTree getStripState(int strip) const;
+    void setStripState(int strip, const juce::ValueTree& state);
+#endif
+
 private:
 
     juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
+    static std::vector<std::unique_ptr<juce::RangedAudioParameter>> createStripParameters(const juce::String& idSuffix, bool withPanner);
     void parameterChanged(const juce::String& parameterID, float newValue) override;
+    void timerCallback() override;
 
-
-
+#if BasicComp_RackStrips == 0
+    // The classic chain; the rack build runs StripRack instead and carries none of it.
     juce::dsp::Gain<float> inputModule;
     juce::dsp::Gain<float> outputModule;
     juce::dsp::Gain<float> faderModule;
-    juce::dsp::Compressor<float> compressorModule;
+    ControlRateCompressor compressorModule;
+    DriveStage driveModule;
     juce::dsp::Panner<float> pannerModule;
+
     void updateParameters();
+    void updateModes();
+
+    // Latency changes made off the message thread, picked up by timerCallback().
+    static constexpr int latencyPollMilliseconds = 100;
+    std::atomic<bool> latencyChangePending{ false };
+    ParameterEventQueue parameterEvents;
+    std::array<ParameterEvent, ParameterEventQueue::capacity> blockEvents;
+    std::array<std::atomic<float>*, numAutomatedParameters> automatedValues{};
+    void applyParameter(int parameterIndex, float value) noexcept;
+    void processRange(juce::AudioBuffer<float>& buffer, int startSample, int numSamples) noexcept;
+
+    struct StageRange
+    {
+        juce::dsp::AudioBlock<float> block, dryBlock;
+        int startSample;
+        bool metering;
+        bool dryNeeded;
+        bool dryTappedAtCompressor;         // else ahead of the input stage
+        bool dryHoldsCompressorInput;       // the input stage wrote into dryBlock
+    };
+
+    using StageChain = void (BasicCompAudioProcessor::*)(StageRange&) noexcept;
+    static const std::array<StageChain, numStageOrders> stageChains;
+    StageChain stageChain{ nullptr };
+    std::atomic<float>* stageOrder{ nullptr };
+    std::array<std::atomic<float>*, numStages> stageBypassParameters{};
+    std::array<bool, numStages> stageBypassed{};
+
+    template <Stage stage, Stage... rest>
+    void processStages(StageRange& range) noexcept;
+    template <Stage stage, bool feedsCompressor>
+    void processStage(StageRange& range) noexcept;
+    void processCompressorStage(StageRange& range) noexcept;
+
+    // Parallel compression: the dry signal is tapped ahead of inputModule or
+    // at the compressor's input, delayed by the wet path's latency and mixed
+    // back in after outputModule, so in every stage order it shares all the
+    // stages except input, compressor and output. Nothing on the dry path
+    // runs while mix sits at 100%.
+    juce::AudioBuffer<float> dryBuffer;
+    juce::dsp::DelayLine<float, juce::dsp::DelayLineInterpolationTypes::None> dryDelay;
+    juce::SmoothedValue<float> mixSmoother;
+    std::atomic<float>* dryPreInput{ nullptr };
+    int dryDelaySamples{ 0 };
+    bool dryPathActive{ false };
+    void updateDryDelay();
+    void mixDrySignal(juce::dsp::AudioBlock<float>& wetBlock, const juce::dsp::AudioBlock<float>& dry) noexcept;
+#endif
+
+    MeterFifo meterFifo;
+    std::atomic<bool> meteringEnabled{ false };
+
+#if BasicComp_RackStrips == 0
+    int meterSamplesPerFrame{ 1 };
+    int meterSamplesPending{ 0 };
+    float meterInputPeak{ 0.0f };
+    float meterGainReductionDb{ 0.0f };
+    bool meteringWasEnabled{ false };       // audio thread, to restart the frame when metering comes back on
+    void restartMeterFrame() noexcept;
+    void pushMeterData(const ControlRateCompressor::DetectorTap& detector, int numSamples) noexcept;
+
+    // The rack build has no loudness analysis or capture, so it leaves the
+    // shared background thread alone.
+    juce::SharedResourcePointer<BackgroundThread> backgroundThread;
+    LoudnessAnalyser loudnessAnalyser{ *backgroundThread };
+
+    enum CaptureSignal { captureInput, captureEnvelope, captureGainReduction, captureOutput, numCaptureSignals };
+    SignalCapture signalCapture{ *backgroundThread };
+    juce::AudioBuffer<float> captureBuffer;
+    double captureSampleRate{ 0.0 };
+    bool capturingBlock{ false };
+    juce::dsp::AudioBlock<float> getCaptureBlock(CaptureSignal signal, int startSample, int numSamples) noexcept;
+    void writeCapture(int numSamples) noexcept;
+
+    // Detector envelope and gain for the meters while nothing is being captured.
+    juce::AudioBuffer<float> meterDetectorBuffer;
+    juce::dsp::AudioBlock<float> getMeterDetectorBlock(int signal, int startSample, int numSamples) noexcept;
+#endif
+
+#if BasicComp_RackStrips > 0
+    StripRack rack;
+    std::array<std::array<std::atomic<float>*, StripRack::numParameters>, BasicComp_RackStrips> stripParameters;
+    void updateRackParameters() noexcept;
+#endif
 
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(BasicCompAudioProcessor)
@@ -0,0 +1,699 @@
+/*
+  ==============================================================================
+
+    ReferenceVerifier.cpp
+
+  ==============================================================================
+*/
+
+#include "ReferenceVerifier.h"
+#include "FastMath.h"
+
+#if BasicComp_Diagnostics
+
+namespace
+{
+    using Preset = ReferenceVerifier::Preset;
+
+    struct NamedSignal
+    {
+        juce::String name;
+        juce::AudioBuffer<float> buffer;
+    };
+
+    //==============================================================================
+    juce::AudioBuffer<float> makeSweep(double sampleRate, int numSamples)
+    {
+        // Log sweep up on the left, down and 6 dB quieter on the right.
+        juce::AudioBuffer<float> buffer(2, numSamples);
+        const auto low = 20.0;
+        const auto high = juce::jmin(20000.0, 0.45 * sampleRate);
+        const auto duration = numSamples / sampleRate;
+        const auto k = std::log(high / low);
+
+        auto phaseAt = [&](double t, double start, double rate)
+        {
+            return juce::MathConstants<double>::twoPi * start * duration / rate * (std::exp(rate * t / duration) - 1.0);
+        };
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const auto t = i / sampleRate;
+            buffer.setSample(0, i, 0.5f * (float)std::sin(phaseAt(t, low, k)));
+            buffer.setSample(1, i, 0.25f * (float)std::sin(phaseAt(t, high, -k)));
+        }
+
+        return buffer;
+    }
+
+    juce::AudioBuffer<float> makeImpulses(double sampleRate, int numSamples)
+    {
+        juce::AudioBuffer<float> buffer(2, numSamples);
+        buffer.clear();
+
+        const float amplitudes[] = { 1.0f, 0.5f, 0.1f, 0.01f };
+        const auto spacing = juce::roundToInt(0.05 * sampleRate);
+        const auto offset = juce::roundToInt(0.01 * sampleRate);
+
+        for (int i = 0, n = 0; i < numSamples; i += spacing, ++n)
+        {
+            const auto amplitude = amplitudes[(size_t)n % std::size(amplitudes)];
+            buffer.setSample(0, i, amplitude);
+
+            if (i + offset < numSamples)
+                buffer.setSample(1, i + offset, -amplitude);
+        }
+
+        return buffer;
+    }
+
+    juce::AudioBuffer<float> makeNoiseBursts(double sampleRate, int numSamples, juce::Random& random)
+    {
+        // 100 ms bursts every 250 ms, each at its own level between -40 and 0 dBFS.
+        juce::AudioBuffer<float> buffer(2, numSamples);
+        buffer.clear();
+
+        const auto period = juce::roundToInt(0.25 * sampleRate);
+        const auto length = juce::roundToInt(0.1 * sampleRate);
+
+        for (int channel = 0; channel < 2; ++channel)
+        {
+            for (int start = 0; start < numSamples; start += period)
+            {
+                const auto gain = juce::Decibels::decibelsToGain(-40.0f * random.nextFloat());
+
+                for (int i = start; i < juce::jmin(numSamples, start + length); ++i)
+                    buffer.setSample(channel, i, gain * (random.nextFloat() * 2.0f - 1.0f));
+            }
+        }
+
+        return buffer;
+    }
+
+    juce::AudioBuffer<float> makeDrums(double sampleRate, int numSamples, juce::Random& random)
+    {
+        // Kick every 500 ms, hats every 125 ms, a slowly breathing noise bed and a tone per side.
+        juce::AudioBuffer<float> buffer(2, numSamples);
+        const auto twoPi = juce::MathConstants<double>::twoPi;
+
+        for (int channel = 0; channel < 2; ++channel)
+        {
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const auto t = i / sampleRate;
+                const auto sinceKick = std::fmod(t, 0.5);
+                const auto kick = 0.9 * std::exp(-sinceKick * 30.0) * std::sin(twoPi * 60.0 * sinceKick);
+                const auto hat = std::fmod(t, 0.125) < 0.01 ? 0.3 * (random.nextDouble() * 2.0 - 1.0) : 0.0;
+                const auto bed = 0.1 * (1.0 + std::sin(twoPi * 0.3 * t)) * (random.nextDouble() * 2.0 - 1.0);
+                const auto tone = 0.2 * std::sin(twoPi * (220.0 + 110.0 * channel) * t);
+                buffer.setSample(channel, i, (float)(kick + hat + bed + tone));
+            }
+        }
+
+        return buffer;
+    }
+
+    std::vector<NamedSignal> makeCorpus(double sampleRate, int numSamples, juce::int64 seed,
+                                        const std::vector<NamedSignal>& programme)
+    {
+        juce::Random random(seed);
+        std::vector<NamedSignal> corpus;
+        corpus.push_back({ "sweep", makeSweep(sampleRate, numSamples) });
+        corpus.push_back({ "impulses", makeImpulses(sampleRate, numSamples) });
+        corpus.push_back({ "noise bursts", makeNoiseBursts(sampleRate, numSamples, random) });
+        corpus.push_back({ "drums", makeDrums(sampleRate, numSamples, random) });
+
+        for (const auto& signal : programme)
+            corpus.push_back(signal);
+
+        return corpus;
+    }
+
+    //==============================================================================
+    /** Renders in blocks of blockSize, the last one shorter, as a host would. */
+    template <typename ProcessFunction>
+    void render(juce::AudioBuffer<float>& buffer, int blockSize, ProcessFunction&& process)
+    {
+        for (int start = 0; start < buffer.getNumSamples(); start += blockSize)
+        {
+            const auto numSamples = juce::jmin(blockSize, buffer.getNumSamples() - start);
+            juce::AudioBuffer<float> block(buffer.getArrayOfWritePointers(), buffer.getNumChannels(), start, numSamples);
+            process(block);
+        }
+    }
+
+    // As the "stageOrder" parameter's choices.
+    const char* const stageOrderNames[] = { "standard", "pan first", "pre-fader" };
+
+    /** Where the chain's stages sit and how much dry signal is mixed back in,
+        as the processor's "stageOrder", "mix" and "dryPreInput" parameters.
+        The dry signal is taken just before the input gain or the compressor
+        and mixed back in after the output gain.
+    */
+    struct Routing
+    {
+        enum Order { standard, panFirst, preFader };
+
+        Order order = standard;
+        float mix = 1.0f;
+        bool dryPreInput = false;
+    };
+
+    /** The classic chain as it was before any optimised kernel replaced part of it. */
+    class ReferenceChain
+    {
+    public:
+        ReferenceChain(const Preset& preset, bool withPanner, Routing chainRouting = {})
+            : usePanner(withPanner), routing(chainRouting)
+        {
+            inputModule.setGainDecibels(preset.inputDb);
+            compressorModule.setThreshold(preset.threshDb);
+            compressorModule.setRatio(preset.ratio);
+            compressorModule.setAttack(preset.attackMs);
+            compressorModule.setRelease(preset.releaseMs);
+            outputModule.setGainDecibels(preset.outputDb);
+            pannerModule.setPan(preset.panner);
+            faderModule.setGainDecibels(preset.faderDb);
+        }
+
+        void prepare(const juce::dsp::ProcessSpec& spec)
+        {
+            inputModule.prepare(spec);
+            inputModule.setRampDurationSeconds(0.01f);
+            compressorModule.prepare(spec);
+            outputModule.prepare(spec);
+            outputModule.setRampDurationSeconds(0.01f);
+            pannerModule.prepare(spec);
+            faderModule.prepare(spec);
+            faderModule.setRampDurationSeconds(0.01f);
+        }
+
+        void process(juce::AudioBuffer<float>& buffer)
+        {
+            juce::dsp::AudioBlock<float> block{ buffer };
+            juce::dsp::ProcessContextReplacing<float> context{ block };
+            const auto mixDry = routing.mix < 1.0f;
+
+            if (usePanner && routing.order == Routing::panFirst)
+                pannerModule.process(context);
+            if (routing.order == Routing::preFader)
+                faderModule.process(context);
+
+            if (mixDry && routing.dryPreInput)
+                dry.makeCopyOf(buffer);
+            inputModule.process(context);
+            if (mixDry && !routing.dryPreInput)
+                dry.makeCopyOf(buffer);
+
+            compressorModule.process(context);
+            outputModule.process(context);
+
+            if (mixDry)
+            {
+                buffer.applyGain(routing.mix);
+
+                for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+                    buffer.addFrom(channel, 0, dry, channel, 0, buffer.getNumSamples(), 1.0f - routing.mix);
+            }
+
+            if (usePanner && routing.order != Routing::panFirst)
+                pannerModule.process(context);
+            if (routing.order != Routing::preFader)
+                faderModule.process(context);
+        }
+
+    private:
+        juce::dsp::Gain<float> inputModule, outputModule, faderModule;
+        juce::dsp::Compressor<float> compressorModule;
+        juce::dsp::Panner<float> pannerModule;
+        bool usePanner;
+        Routing routing;
+        juce::AudioBuffer<float> dry;
+    };
+
+    //==============================================================================
+    // Double precision drive curves and antiderivatives, straight from their definitions.
+    double driveCurve(DriveStage::Curve curve, double x)
+    {
+        switch (curve)
+        {
+            case DriveStage::Curve::tanh:       return std::tanh(x);
+            case DriveStage::Curve::tube:       return x >= 0.0 ? x / (1.0 + x) : std::tanh(x);
+            case DriveStage::Curve::hardClip:   return juce::jlimit(-1.0, 1.0, x);
+            case DriveStage::Curve::off:        break;
+        }
+
+        return x;
+    }
+
+    double driveAntiderivative(DriveStage::Curve curve, double x)
+    {
+        switch (curve)
+        {
+            case DriveStage::Curve::tanh:       return std::log(std::cosh(x));
+            case DriveStage::Curve::tube:       return x >= 0.0 ? x - std::log1p(x) : std::log(std::cosh(x));
+            case DriveStage::Curve::hardClip:   return std::abs(x) <= 1.0 ? 0.5 * x * x : std::abs(x) - 0.5;
+            case DriveStage::Curve::off:        break;
+        }
+
+        return 0.5 * x * x;
+    }
+
+    void applyDriveCurve(juce::dsp::AudioBlock<float>& block, DriveStage::Curve curve)
+    {
+        for (size_t channel = 0; channel < block.getNumChannels(); ++channel)
+        {
+            auto* samples = block.getChannelPointer(channel);
+            double previous = 0.0;
+
+            for (size_t i = 0; i < block.getNumSamples(); ++i)
+            {
+                const auto x = (double)samples[i];
+                const auto y = std::abs(x - previous) < 1.0e-9
+                             ? driveCurve(curve, 0.5 * (x + previous))
+                             : (driveAntiderivative(curve, x) - driveAntiderivative(curve, previous)) / (x - previous);
+                previous = x;
+                samples[i] = (float)y;
+            }
+        }
+    }
+
+    /** With oversampling the curve runs between the same JUCE 2x filters
+        DriveStage uses, so what is checked is the kernel at the higher rate
+        and that latency and DC removal stay where they belong.
+    */
+    void renderDriveReference(juce::AudioBuffer<float>& buffer, DriveStage::Curve curve, float driveDb,
+                              double sampleRate, bool oversampled)
+    {
+        buffer.applyGain(juce::Decibels::decibelsToGain(driveDb));
+        juce::dsp::AudioBlock<float> block{ buffer };
+
+        if (oversampled)
+        {
+            juce::dsp::Oversampling<float> oversampler((size_t)buffer.getNumChannels(), 1,
+                                                       juce::dsp::Oversampling<float>::filterHalfBandFIREquiripple, true, true);
+            oversampler.initProcessing((size_t)buffer.getNumSamples());
+            auto upsampled = oversampler.processSamplesUp(block);
+            applyDriveCurve(upsampled, curve);
+            oversampler.processSamplesDown(block);
+        }
+        else
+        {
+            applyDriveCurve(block, curve);
+        }
+
+        if (curve != DriveStage::Curve::tube)
+            return;
+
+        const auto dcCoefficient = std::exp(-juce::MathConstants<double>::twoPi * 10.0 / sampleRate);
+
+        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+        {
+            auto* samples = buffer.getWritePointer(channel);
+            double dcInput = 0.0, dcOutput = 0.0;
+
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+            {
+                dcOutput = samples[i] - dcInput + dcCoefficient * dcOutput;
+                dcInput = samples[i];
+                samples[i] = (float)dcOutput;
+            }
+        }
+    }
+
+    //==============================================================================
+    struct Errors
+    {
+        float maxSampleError{ 0.0f };
+        float maxGainErrorDb{ 0.0f };
+    };
+
+    /** Gain errors compare output magnitudes, which cancels the input sample
+        out; both paths are linear in it once their gains are fixed.
+    */
+    Errors compare(const juce::AudioBuffer<float>& reference, const juce::AudioBuffer<float>& tested, float gainErrorFloor)
+    {
+        Errors errors;
+
+        for (int channel = 0; channel < reference.getNumChannels(); ++channel)
+        {
+            const auto* expected = reference.getReadPointer(channel);
+            const auto* actual = tested.getReadPointer(channel);
+
+            for (int i = 0; i < reference.getNumSamples(); ++i)
+            {
+                errors.maxSampleError = juce::jmax(errors.maxSampleError, std::abs(actual[i] - expected[i]));
+
+                if (std::abs(expected[i]) > gainErrorFloor)
+                {
+                    const auto ratio = std::abs(actual[i]) / std::abs(expected[i]);
+                    const auto errorDb = ratio > 0.0f ? std::abs(juce::Decibels::gainToDecibels(ratio, -200.0f)) : 200.0f;
+                    errors.maxGainErrorDb = juce::jmax(errors.maxGainErrorDb, errorDb);
+                }
+            }
+        }
+
+        return errors;
+    }
+
+    /** FastMath against the standard library in double, over every 97th
+        float: log2 as an absolute error across the normal range (as sample
+        error), exp2 as a gain error in dB across its clamped range.
+    */
+    Errors measureFastMath()
+    {
+        Errors errors;
+
+        for (auto bits = (std::int64_t)0x00800000; bits < 0x7f800000; bits += 97)
+        {
+            const auto x = FastMath::bitsToFloat((std::int32_t)bits);
+            const auto error = std::abs((double)FastMath::log2(x) - std::log2((double)x));
+            errors.maxSampleError = juce::jmax(errors.maxSampleError, (float)error);
+        }
+
+        for (auto bits = (std::int64_t)0; bits < 0x100000000; bits += 97)
+        {
+            const auto x = FastMath::bitsToFloat((std::int32_t)(std::uint32_t)bits);
+
+            if (!(std::abs(x) <= 126.0f))
+                continue;
+
+            const auto ratio = (double)FastMath::exp2(x) / std::exp2((double)x);
+            errors.maxGainErrorDb = juce::jmax(errors.maxGainErrorDb, (float)std::abs(20.0 * std::log10(ratio)));
+        }
+
+        return errors;
+    }
+
+#if BasicComp_RackStrips == 0
+    void setParameter(BasicCompAudioProcessor& processor, const juce::String& id, float value)
+    {
+        auto* param = processor.treeState.getParameter(id);
+        jassert(param != nullptr);
+        param->setValueNotifyingHost(param->convertTo0to1(value));
+    }
+
+    /** Prepares the processor and runs silence through it until its gain
+        ramps have settled, so the signal meets fixed gains as it does in the
+        reference chain, whose gains are set before it is prepared.
+    */
+    void prepareProcessor(BasicCompAudioProcessor& processor, double sampleRate, int blockSize)
+    {
+        processor.setNonRealtime(true);
+        processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+        processor.prepareToPlay(sampleRate, blockSize);
+
+        juce::AudioBuffer<float> silence(2, juce::roundToInt(0.05 * sampleRate));
+        silence.clear();
+        juce::MidiBuffer midi;
+        render(silence, blockSize, [&](juce::AudioBuffer<float>& block) { processor.processBlock(block, midi); });
+    }
+
+    void applyPreset(BasicCompAudioProcessor& processor, const Preset& preset, int quality)
+    {
+        setParameter(processor, "input", preset.inputDb);
+        setParameter(processor, "thresh", preset.threshDb);
+        setParameter(processor, "ratio", preset.ratio);
+        setParameter(processor, "attack", preset.attackMs);
+        setParameter(processor, "release", preset.releaseMs);
+        setParameter(processor, "output", preset.outputDb);
+        setParameter(processor, "panner", preset.panner);
+        setParameter(processor, "fader", preset.faderDb);
+        setParameter(processor, "quality", (float)quality);
+    }
+#endif
+}
+
+//==============================================================================
+juce::Array<ReferenceVerifier::Preset> ReferenceVerifier::getDefaultPresets()
+{
+    return {
+        { "default",    0.0f,   0.0f,  1.0f, 10.0f,  125.0f, 0.0f,  0.0f,  0.0f },
+        { "vocal",      0.0f, -18.0f,  4.0f,  5.0f,  125.0f, 6.0f,  0.0f,  0.0f },
+        { "bus glue",   0.0f, -12.0f,  2.0f, 30.0f,  300.0f, 3.0f, -0.3f, -2.0f },
+        { "limiter",    6.0f,  -6.0f, 20.0f,  0.1f,   50.0f, 0.0f,  0.0f, -1.0f },
+        { "crush",     10.0f, -30.0f, 10.0f, 0.01f,    5.0f, 12.0f, 0.8f, -6.0f }
+    };
+}
+
+juce::String ReferenceVerifier::Report::toString() const
+{
+    auto describe = [](const CaseResult& result)
+    {
+        return result.path + " / " + result.preset + " / " + result.signal + " @ " + juce::String(result.sampleRate, 0)
+             + ": sample error " + juce::String(result.maxSampleError, 7)
+             + ", gain error " + juce::String(result.maxGainErrorDb, 4) + " dB";
+    };
+
+    juce::StringArray paths;
+    for (const auto& result : cases)
+        paths.addIfNotAlreadyThere(result.path);
+
+    juce::String text;
+    text << "worst case per path" << juce::newLine;
+
+    for (const auto& path : paths)
+    {
+        CaseResult worstSample, worstGain;
+
+        for (const auto& result : cases)
+        {
+            if (result.path != path)
+                continue;
+
+            if (worstSample.path.isEmpty() || result.maxSampleError > worstSample.maxSampleError)
+                worstSample = result;
+            if (worstGain.path.isEmpty() || result.maxGainErrorDb > worstGain.maxGainErrorDb)
+                worstGain = result;
+        }
+
+        text << "  " << describe(worstSample) << juce::newLine;
+        if (worstGain.preset != worstSample.preset || worstGain.signal != worstSample.signal
+            || worstGain.sampleRate != worstSample.sampleRate)
+            text << "  " << describe(worstGain) << juce::newLine;
+    }
+
+    for (const auto& result : cases)
+        if (!result.passed)
+            text << "FAILED " << describe(result) << juce::newLine;
+
+    text << (passed ? "PASSED" : "FAILED") << ": " << cases.size() << " cases, " << numFailed << " failed" << juce::newLine;
+    return text;
+}
+
+ReferenceVerifier::Report ReferenceVerifier::run(const Options& options)
+{
+    Report report;
+
+    auto addCase = [&](const juce::String& path, const juce::String& preset, const juce::String& signal,
+                       double sampleRate, const Errors& errors, const Tolerance& tolerance)
+    {
+        CaseResult result;
+        result.path = path;
+        result.preset = preset;
+        result.signal = signal;
+        result.sampleRate = sampleRate;
+        result.maxSampleError = errors.maxSampleError;
+        result.maxGainErrorDb = errors.maxGainErrorDb;
+        result.passed = errors.maxSampleError <= tolerance.maxSampleError
+                     && errors.maxGainErrorDb <= tolerance.maxGainErrorDb;
+        report.cases.add(result);
+    };
+
+    // Programme material is read once; a file that cannot be read fails the run.
+    std::vector<NamedSignal> programme;
+    {
+        juce::AudioFormatManager formats;
+        formats.registerBasicFormats();
+
+        for (const auto& file : options.programmeFiles)
+        {
+            std::unique_ptr<juce::AudioFormatReader> reader(formats.createReaderFor(file));
+
+            if (reader == nullptr)
+            {
+                CaseResult unreadable;
+                unreadable.path = "programme";
+                unreadable.signal = file.getFullPathName();
+                report.cases.add(unreadable);
+                continue;
+            }
+
+            const auto numSamples = (int)juce::jmin(reader->lengthInSamples,
+                                                    (juce::int64)(options.signalSeconds * reader->sampleRate));
+            juce::AudioBuffer<float> buffer(2, numSamples);
+            reader->read(&buffer, 0, numSamples, 0, true, true);
+            programme.push_back({ file.getFileNameWithoutExtension(), std::move(buffer) });
+        }
+    }
+
+    const auto gainErrorFloor = juce::Decibels::decibelsToGain(options.gainErrorFloorDb, -200.0f);
+    const auto noGainError = std::numeric_limits<float>::infinity();
+
+    addCase("fast math", "log2 / exp2", "all floats", 0.0, measureFastMath(), options.fastMathFunctionTolerance);
+
+    for (auto sampleRate : options.sampleRates)
+    {
+        const auto numSamples = juce::roundToInt(options.signalSeconds * sampleRate);
+        const auto corpus = makeCorpus(sampleRate, numSamples, options.randomSeed, programme);
+        const juce::dsp::ProcessSpec spec{ sampleRate, (juce::uint32)options.blockSize, 2 };
+
+        for (const auto& signal : corpus)
+        {
+            for (const auto& preset : options.presets)
+            {
+                auto reference = signal.buffer;
+                ReferenceChain referenceChain(preset, true);
+                referenceChain.prepare(spec);
+                render(reference, options.blockSize, [&](juce::AudioBuffer<float>& block) { referenceChain.process(block); });
+
+#if BasicComp_RackStrips == 0
+                // The plugin itself, at each quality setting. Drive stays off and mix at 100%.
+                for (int quality = 0; quality < 5; ++quality)
+                {
+                    BasicCompAudioProcessor processor;
+                    applyPreset(processor, preset, quality);
+                    prepareProcessor(processor, sampleRate, options.blockSize);
+
+                    auto tested = signal.buffer;
+                    juce::MidiBuffer midi;
+                    render(tested, options.blockSize, [&](juce::AudioBuffer<float>& block) { processor.processBlock(block, midi); });
+                    processor.releaseResources();
+
+                    const auto path = quality == 0 ? juce::String("processor full")
+                                    : quality == 4 ? juce::String("processor eco summary")
+                                                   : "processor eco x" + juce::String(2 << quality);
+                    addCase(path, preset.name, signal.name, sampleRate, compare(reference, tested, gainErrorFloor),
+                            quality == 0 ? options.exactTolerance : quality == 4 ? options.ecoSummaryTolerance : options.ecoTolerance);
+                }
+
+                // The other stage orders, and every order blended with the dry
+                // signal from either tap, against the chain routed the same way.
+                for (int order = 0; order < BasicCompAudioProcessor::numStageOrders; ++order)
+                {
+                    const auto dryMix = options.dryMixPercent / 100.0f;
+                    const Routing routings[] = { { (Routing::Order)order, 1.0f, false },
+                                                 { (Routing::Order)order, dryMix, false },
+                                                 { (Routing::Order)order, dryMix, true } };
+
+                    for (const auto& routing : routings)
+                    {
+                        if (routing.order == Routing::standard && routing.mix == 1.0f)
+                            continue;
+
+                        auto expected = signal.buffer;
+                        ReferenceChain routedReference(preset, true, routing);
+                        routedReference.prepare(spec);
+                        render(expected, options.blockSize, [&](juce::AudioBuffer<float>& block) { routedReference.process(block); });
+
+                        BasicCompAudioProcessor processor;
+                        applyPreset(processor, preset, 0);
+                        setParameter(processor, "stageOrder", (float)order);
+                        setParameter(processor, "mix", routing.mix * 100.0f);
+                        setParameter(processor, "dryPreInput", routing.dryPreInput ? 1.0f : 0.0f);
+                        prepareProcessor(processor, sampleRate, options.blockSize);
+
+                        auto tested = signal.buffer;
+                        juce::MidiBuffer midi;
+                        render(tested, options.blockSize, [&](juce::AudioBuffer<float>& block) { processor.processBlock(block, midi); });
+                        processor.releaseResources();
+
+                        auto path = "processor " + juce::String(stageOrderNames[order]);
+                        if (routing.mix < 1.0f)
+                            path << ", mix " << juce::String(options.dryMixPercent, 0) << "%, dry "
+                                 << (routing.dryPreInput ? "pre-input" : "at compressor");
+
+                        addCase(path, preset.name, signal.name, sampleRate, compare(expected, tested, gainErrorFloor),
+                                options.exactTolerance);
+                    }
+                }
+#endif
+
+                // Two rack strips against the chain without its panner.
+                auto referenceWithoutPanner = signal.buffer;
+                ReferenceChain stripReference(preset, false);
+                stripReference.prepare(spec);
+                render(referenceWithoutPanner, options.blockSize, [&](juce::AudioBuffer<float>& block) { stripReference.process(block); });
+
+                StripRack rack;
+                rack.prepare(sampleRate, 2);
+                const StripSettings settings{ preset.inputDb, preset.threshDb, preset.ratio, preset.attackMs,
+                                              preset.releaseMs, preset.outputDb, preset.faderDb };
+                rack.setStrip(0, settings);
+                rack.setStrip(1, settings);
+
+                auto tested = signal.buffer;
+                render(tested, options.blockSize, [&](juce::AudioBuffer<float>& block) { rack.process(block); });
+                addCase("strip rack", preset.name, signal.name, sampleRate,
+                        compare(referenceWithoutPanner, tested, gainErrorFloor), options.fastMathTolerance);
+            }
+
+#if BasicComp_RackStrips == 0
+            // Fader at its minimum with mix at 50% must silence the dry signal
+            // too, in every stage order and at both dry tap points.
+            for (int order = 0; order < BasicCompAudioProcessor::numStageOrders; ++order)
+            {
+                for (bool preInput : { false, true })
+                {
+                    BasicCompAudioProcessor processor;
+                    applyPreset(processor, options.presets.getFirst(), 0);
+                    setParameter(processor, "stageOrder", (float)order);
+                    setParameter(processor, "dryPreInput", preInput ? 1.0f : 0.0f);
+                    setParameter(processor, "mix", 50.0f);
+                    setParameter(processor, "fader", processor.treeState.getParameterRange("fader").start);
+                    prepareProcessor(processor, sampleRate, options.blockSize);
+
+                    auto tested = signal.buffer;
+                    juce::MidiBuffer midi;
+                    render(tested, options.blockSize, [&](juce::AudioBuffer<float>& block) { processor.processBlock(block, midi); });
+                    processor.releaseResources();
+
+                    juce::AudioBuffer<float> silence(tested.getNumChannels(), tested.getNumSamples());
+                    silence.clear();
+                    addCase("stage order " + juce::String(stageOrderNames[order]), preInput ? "dry pre-input" : "dry at compressor",
+                            signal.name, sampleRate, compare(silence, tested, noGainError), options.mutedFaderTolerance);
+                }
+            }
+#endif
+
+            for (auto curve : { DriveStage::Curve::tanh, DriveStage::Curve::tube, DriveStage::Curve::hardClip })
+            {
+                const juce::String curveNames[] = { "off", "tanh", "tube", "hard clip" };
+
+                for (auto driveDb : options.driveLevelsDb)
+                {
+                    for (bool oversampled : { false, true })
+                    {
+                        DriveStage drive;
+                        drive.setDriveDecibels(driveDb);
+                        drive.setCurve(curve);
+                        drive.setOversampling(oversampled);
+                        drive.prepare(spec);
+
+                        auto tested = signal.buffer;
+                        render(tested, options.blockSize, [&](juce::AudioBuffer<float>& block)
+                        {
+                            juce::dsp::AudioBlock<float> audioBlock{ block };
+                            drive.process(juce::dsp::ProcessContextReplacing<float>(audioBlock));
+                        });
+
+                        auto reference = signal.buffer;
+                        renderDriveReference(reference, curve, driveDb, sampleRate, oversampled);
+
+                        addCase("drive " + curveNames[(int)curve] + (oversampled ? " 2x" : ""), juce::String(driveDb, 0) + " dB",
+                                signal.name, sampleRate, compare(reference, tested, noGainError), options.driveTolerance);
+                    }
+                }
+            }
+        }
+    }
+
+    for (const auto& result : report.cases)
+        if (!result.passed)
+            ++report.numFailed;
+
+    report.passed = report.numFailed == 0 && !report.cases.isEmpty();
+    return report;
+}
+
+#endif
@@ -0,0 +1,116 @@
+/*
+  ==============================================================================
+
+    ReferenceVerifier.h
+
+    Checks the optimised DSP paths against a plain reference: the original
+    juce::dsp chain (inputModule -> Compressor -> outputModule -> pannerModule
+    -> faderModule) and a double precision ADAA for the drive curves. A
+    corpus of stereo signals (log sweep, impulse train, noise bursts, a
+    synthetic drum mix and any programme files given) is rendered through
+    both at every preset and sample rate, and each path must stay within its
+    tolerance for maximum sample error and maximum gain error in dB.
+
+    Paths and what they are held to:
+      processor full       the plugin's own processBlock, quality Full: exact
+      processor eco xN     the same with an eco quality: ecoTolerance
+      processor eco summary
+                           the same with Eco x16 Summary: ecoSummaryTolerance
+      processor <order>[, mix]
+                           the plugin in Pan First and Pre-Fader order at 100%
+                           mix, and in every order at dryMixPercent from both dry
+                           taps, against the chain routed the same way: exact
+      strip rack           StripRack's FastMath kernel, no panner: fastMathTolerance
+      drive <curve>[ 2x]   DriveStage at 1x, and at 2x between the same JUCE
+                           oversampling filters, against double ADAA:
+                           driveTolerance (sample error only)
+      fast math            FastMath::log2 (absolute, as sample error) and exp2
+                           (as gain error) in double: fastMathFunctionTolerance
+      stage order <order>  the plugin with its fader at minimum and mix at 50%,
+                           against silence: mutedFaderTolerance (sample error only)
+
+    Only compiled with BasicComp_Diagnostics=1; run() from the message thread,
+    e.g. through the "verify" command of Diagnostics/BasicCompDiagnostics.jucer.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "PluginProcessor.h"
+
+#if BasicComp_Diagnostics
+
+class ReferenceVerifier
+{
+public:
+    struct Preset
+    {
+        juce::String name;
+        float inputDb, threshDb, ratio, attackMs, releaseMs, outputDb, panner, faderDb;
+    };
+
+    struct Tolerance
+    {
+        float maxSampleError;
+        float maxGainErrorDb;
+    };
+
+    static juce::Array<Preset> getDefaultPresets();
+
+    struct Options
+    {
+        juce::Array<double> sampleRates{ 44100.0, 48000.0, 88200.0, 96000.0, 192000.0 };
+        juce::Array<Preset> presets = getDefaultPresets();
+
+        /** Any format AudioFormatManager's basic formats read; the first
+            signalSeconds are used as they are at every rate, without resampling.
+        */
+        juce::Array<juce::File> programmeFiles;
+
+        double signalSeconds{ 2.0 };
+        int blockSize{ 512 };
+        juce::Array<float> driveLevelsDb{ 0.0f, 12.0f, 24.0f };
+
+        // Mix for the blended routing cases; not 50%, so swapped wet and dry weights show.
+        float dryMixPercent{ 35.0f };
+
+        // Gain errors are only measured where the reference output is above this.
+        float gainErrorFloorDb{ -80.0f };
+
+        Tolerance exactTolerance{ 1.0e-6f, 0.001f };
+        Tolerance fastMathTolerance{ 1.0e-4f, 0.01f };
+        Tolerance fastMathFunctionTolerance{ 4.0e-6f, 2.5e-6f };
+        // ControlRateCompressor's documented worst case against the full-rate path.
+        Tolerance ecoTolerance{ 0.1f, 1.2f };
+        // And with its summary detector.
+        Tolerance ecoSummaryTolerance{ 0.3f, 3.5f };
+        Tolerance driveTolerance{ 1.0e-3f, 0.0f };
+        Tolerance mutedFaderTolerance{ 1.0e-4f, 0.0f };
+
+        juce::int64 randomSeed{ 1 };
+    };
+
+    struct CaseResult
+    {
+        juce::String path, preset, signal;
+        double sampleRate{ 0.0 };
+        float maxSampleError{ 0.0f };
+        float maxGainErrorDb{ 0.0f };
+        bool passed{ false };
+    };
+
+    struct Report
+    {
+        juce::Array<CaseResult> cases;
+        int numFailed{ 0 };
+        bool passed{ false };
+
+        /** Worst case of each path, then every failing case. */
+        juce::String toString() const;
+    };
+
+    static Report run(const Options& options);
+};
+
+#endif
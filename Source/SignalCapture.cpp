@@ -0,0 +1,79 @@
+/*
+  ==============================================================================
+
+    SignalCapture.cpp
+
+  ==============================================================================
+*/
+
+#include "SignalCapture.h"
+
+SignalCapture::SignalCapture(juce::TimeSliceThread& writerThread)
+    : thread(writerThread)
+{
+}
+
+SignalCapture::~SignalCapture()
+{
+    stop();
+}
+
+bool SignalCapture::start(const juce::File& file, double sampleRate, int numChannels)
+{
+    stop();
+
+    if (sampleRate <= 0.0 || numChannels <= 0)
+        return false;
+
+    file.deleteFile();
+    auto stream = file.createOutputStream();
+
+    if (stream == nullptr)
+        return false;
+
+    juce::WavAudioFormat wav;
+    std::unique_ptr<juce::AudioFormatWriter> writer(wav.createWriterFor(stream.get(), sampleRate, (unsigned int)numChannels,
+                                                                         32, {}, 0));
+    if (writer == nullptr)
+        return false;
+
+    stream.release(); // now owned by the writer
+
+    // The FIFO is allocated here, on the message thread, before the audio thread can see it.
+    threadedWriter = std::make_unique<juce::AudioFormatWriter::ThreadedWriter>(writer.release(), thread, fifoSamples);
+    droppedSamples.store(0);
+
+    const juce::ScopedLock lock(writerLock);
+    activeWriter.store(threadedWriter.get());
+    return true;
+}
+
+void SignalCapture::stop()
+{
+    {
+        const juce::ScopedLock lock(writerLock);
+        activeWriter.store(nullptr);
+    }
+
+    // Flushes whatever is still queued and closes the file.
+    threadedWriter.reset();
+}
+
+void SignalCapture::write(const float* const* channels, int numSamples) noexcept
+{
+    if (activeWriter.load() == nullptr)
+        return;
+
+    // Only contended while start() or stop() swap the writer.
+    const juce::ScopedTryLock lock(writerLock);
+
+    if (!lock.isLocked())
+    {
+        droppedSamples += numSamples;
+        return;
+    }
+
+    if (auto* writer = activeWriter.load())
+        if (!writer->write(channels, numSamples))
+            droppedSamples += numSamples;
+}
@@ -0,0 +1,55 @@
+/*
+  ==============================================================================
+
+    SignalCapture.h
+
+    Streams internal signals from the audio thread to a 32-bit float WAV file
+    for offline analysis. The audio thread hands each block to a
+    juce::AudioFormatWriter::ThreadedWriter, whose lock-free FIFO the shared
+    background thread drains to disk. Capture can be started and stopped
+    while audio runs: the audio thread only ever try-locks against start() and
+    stop(), never allocates, and when the FIFO is full or the lock is taken
+    the block is dropped and counted instead.
+
+    Float WAV keeps values outside +-1, so channels may hold anything (the
+    processor writes gain reduction in dB, for example).
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class SignalCapture
+{
+public:
+    explicit SignalCapture(juce::TimeSliceThread& writerThread);
+    ~SignalCapture();
+
+    /** Message thread. Starts a new numChannels file, replacing any capture in
+        progress; returns false if the file could not be created.
+    */
+    bool start(const juce::File& file, double sampleRate, int numChannels);
+    void stop();
+
+    bool isCapturing() const noexcept { return activeWriter.load() != nullptr; }
+
+    /** Audio thread. numChannels must match start(). */
+    void write(const float* const* channels, int numSamples) noexcept;
+
+    /** Samples (per channel) dropped since the last start(). */
+    juce::int64 getNumDroppedSamples() const noexcept { return droppedSamples.load(); }
+
+    /** About 3 s at 48 kHz before the writer has to catch up. */
+    static constexpr int fifoSamples = 1 << 17;
+
+private:
+    juce::TimeSliceThread& thread;
+    juce::CriticalSection writerLock;
+    std::unique_ptr<juce::AudioFormatWriter::ThreadedWriter> threadedWriter;
+    std::atomic<juce::AudioFormatWriter::ThreadedWriter*> activeWriter{ nullptr };
+    std::atomic<juce::int64> droppedSamples{ 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SignalCapture)
+};
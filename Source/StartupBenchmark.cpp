@@ -0,0 +1,113 @@
+/*
+  ==============================================================================
+
+    StartupBenchmark.cpp
+
+  ==============================================================================
+*/
+
+#include "StartupBenchmark.h"
+
+#if BasicComp_Diagnostics
+
+juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter();
+
+namespace
+{
+    double millisecondsSince(juce::int64 startTicks)
+    {
+        return juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks) * 1000.0;
+    }
+}
+
+juce::Array<StartupBenchmark::Result> StartupBenchmark::run(const Options& options)
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+
+    // Saved settings as a session would hold them: random values for every
+    // parameter, serialised by a scratch instance outside the timed region.
+    std::vector<juce::MemoryBlock> stateBlobs;
+    {
+        std::unique_ptr<juce::AudioProcessor> scratch(createPluginFilter());
+        juce::Random random(options.randomSeed);
+
+        for (int i = 0; i < 16; ++i)
+        {
+            for (auto* param : scratch->getParameters())
+                param->setValueNotifyingHost(random.nextFloat());
+
+            juce::MemoryBlock blob;
+            scratch->getStateInformation(blob);
+            stateBlobs.push_back(std::move(blob));
+        }
+    }
+
+    juce::Array<Result> results;
+
+    for (auto numInstances : options.instanceCounts)
+    {
+        std::vector<std::unique_ptr<juce::AudioProcessor>> instances;
+        instances.reserve((size_t)numInstances);
+        Timings sum;
+
+        const auto runStart = juce::Time::getHighResolutionTicks();
+
+        for (int i = 0; i < numInstances; ++i)
+        {
+            auto start = juce::Time::getHighResolutionTicks();
+            instances.emplace_back(createPluginFilter());
+            sum.construct += millisecondsSince(start);
+
+            auto& processor = *instances.back();
+
+            start = juce::Time::getHighResolutionTicks();
+            processor.setRateAndBufferSizeDetails(options.sampleRate, options.blockSize);
+            processor.prepareToPlay(options.sampleRate, options.blockSize);
+            sum.prepare += millisecondsSince(start);
+
+            const auto& blob = stateBlobs[(size_t)i % stateBlobs.size()];
+            start = juce::Time::getHighResolutionTicks();
+            processor.setStateInformation(blob.getData(), (int)blob.getSize());
+            sum.loadState += millisecondsSince(start);
+
+            if (options.includeEditor)
+            {
+                start = juce::Time::getHighResolutionTicks();
+                std::unique_ptr<juce::AudioProcessorEditor> editor(processor.createEditorIfNeeded());
+                sum.createEditor += millisecondsSince(start);
+            }
+        }
+
+        Result result;
+        result.numInstances = numInstances;
+        result.totalMs = millisecondsSince(runStart);
+        result.perInstance = { sum.construct / numInstances, sum.prepare / numInstances,
+                               sum.loadState / numInstances, sum.createEditor / numInstances };
+        results.add(result);
+
+        for (auto& instance : instances)
+            instance->releaseResources();
+    }
+
+    return results;
+}
+
+juce::String StartupBenchmark::toString(const juce::Array<Result>& results)
+{
+    auto column = [](double value) { return juce::String(value, 3).paddedLeft(' ', 10); };
+
+    juce::String text;
+    text << " instances  construct    prepare  loadState     editor  per inst.   total ms" << juce::newLine;
+
+    for (const auto& result : results)
+    {
+        text << juce::String(result.numInstances).paddedLeft(' ', 10)
+             << column(result.perInstance.construct) << column(result.perInstance.prepare)
+             << column(result.perInstance.loadState) << column(result.perInstance.createEditor)
+             << column(result.perInstance.getTotal()) << column(result.totalMs) << juce::newLine;
+    }
+
+    return text;
+}
+
+#endif
@@ -0,0 +1,59 @@
+/*
+  ==============================================================================
+
+    StartupBenchmark.h
+
+    Times what a host does when it opens a session, per instance: plugin
+    construction (createPluginFilter, i.e. the parameter layout and listener
+    registration), prepareToPlay, setStateInformation with saved settings
+    and createEditor. Each instance count in the scaling curve keeps all of
+    its instances alive, as a session does, so costs that grow with the
+    number of instances in the process show up as a rising per-instance cost.
+
+    Only compiled with BasicComp_Diagnostics=1; run() from the message thread,
+    e.g. through the "startup" command of Diagnostics/BasicCompDiagnostics.jucer.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "PluginProcessor.h"
+
+#if BasicComp_Diagnostics
+
+class StartupBenchmark
+{
+public:
+    struct Options
+    {
+        juce::Array<int> instanceCounts{ 1, 10, 100, 250, 500, 1000 };
+        double sampleRate{ 48000.0 };
+        int blockSize{ 512 };
+        bool includeEditor{ true };
+        juce::int64 randomSeed{ 1 };
+    };
+
+    /** Mean milliseconds per instance for each step. */
+    struct Timings
+    {
+        double construct{ 0.0 };
+        double prepare{ 0.0 };
+        double loadState{ 0.0 };
+        double createEditor{ 0.0 };
+
+        double getTotal() const noexcept { return construct + prepare + loadState + createEditor; }
+    };
+
+    struct Result
+    {
+        int numInstances{ 0 };
+        Timings perInstance;
+        double totalMs{ 0.0 };
+    };
+
+    static juce::Array<Result> run(const Options& options);
+    static juce::String toString(const juce::Array<Result>& results);
+};
+
+#endif
@@ -0,0 +1,216 @@
+/*
+  ==============================================================================
+
+    StressHarness.cpp
+
+  ==============================================================================
+*/
+
+#include "StressHarness.h"
+
+#if BasicComp_Diagnostics
+
+juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter();
+
+//==============================================================================
+void CallbackStressHarness::Histogram::add(double microseconds) noexcept
+{
+    const auto bucket = juce::jlimit(0, numBuckets - 1, (int)microseconds);
+    ++buckets[(size_t)bucket];
+    ++total;
+    maxMicroseconds = juce::jmax(maxMicroseconds, microseconds);
+}
+
+double CallbackStressHarness::Histogram::getPercentile(double percentile) const noexcept
+{
+    if (total == 0)
+        return 0.0;
+
+    const auto rank = (juce::int64)std::ceil(percentile / 100.0 * (double)total);
+    juce::int64 seen = 0;
+
+    for (int bucket = 0; bucket < numBuckets; ++bucket)
+    {
+        seen += buckets[(size_t)bucket];
+
+        if (seen >= rank)
+            return juce::jmin((double)(bucket + 1), maxMicroseconds);
+    }
+
+    return maxMicroseconds;
+}
+
+juce::String CallbackStressHarness::Histogram::toAsciiArt() const
+{
+    // Octave wide rows (0-1 us, 1-2 us, 2-4 us, ...) keep the tail readable.
+    juce::String text;
+    juce::int64 largest = 1;
+    std::vector<juce::int64> rows;
+
+    for (int low = 0, high = 1; low < numBuckets; low = high, high *= 2)
+    {
+        juce::int64 count = 0;
+
+        for (int bucket = low; bucket < juce::jmin(high, numBuckets); ++bucket)
+            count += buckets[(size_t)bucket];
+
+        rows.push_back(count);
+        largest = juce::jmax(largest, count);
+    }
+
+    for (size_t row = 0, low = 0, high = 1; row < rows.size(); ++row, low = high, high *= 2)
+    {
+        if (rows[row] == 0)
+            continue;
+
+        text << juce::String(low).paddedLeft(' ', 7) << " - " << juce::String(high).paddedLeft(' ', 7) << " us "
+             << juce::String::repeatedString("#", juce::jmax(1, (int)(50 * rows[row] / largest)))
+             << " " << juce::String(rows[row]) << juce::newLine;
+    }
+
+    return text;
+}
+
+//==============================================================================
+juce::String CallbackStressHarness::Report::toString() const
+{
+    juce::String text;
+    text << "callbacks " << numCallbacks << juce::newLine
+         << "p50   " << juce::String(p50Microseconds, 1) << " us" << juce::newLine
+         << "p99   " << juce::String(p99Microseconds, 1) << " us" << juce::newLine
+         << "p99.9 " << juce::String(p999Microseconds, 1) << " us" << juce::newLine
+         << "max   " << juce::String(maxMicroseconds, 1) << " us" << juce::newLine
+         << histogram
+         << (passed ? "PASSED" : "FAILED") << ": tail " << juce::String(tailMicroseconds, 1) << " us" << juce::newLine;
+    return text;
+}
+
+CallbackStressHarness::Report CallbackStressHarness::run(const Options& options)
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+
+    std::unique_ptr<juce::AudioProcessor> processor(createPluginFilter());
+    const int numChannels = juce::jmax(processor->getTotalNumInputChannels(), processor->getTotalNumOutputChannels());
+
+    auto prepare = [&](double sampleRate)
+    {
+        processor->releaseResources();
+        processor->setRateAndBufferSizeDetails(sampleRate, options.maxBlockSize);
+        processor->prepareToPlay(sampleRate, options.maxBlockSize);
+    };
+
+    prepare(options.sampleRates.getFirst());
+
+    // Realistic state blobs to throw at setStateInformation: the defaults plus
+    // a few random settings, captured before anything runs concurrently.
+    std::vector<juce::MemoryBlock> stateBlobs;
+    {
+        juce::Random random(options.randomSeed);
+
+        for (int i = 0; i < 8; ++i)
+        {
+            juce::MemoryBlock blob;
+            processor->getStateInformation(blob);
+            stateBlobs.push_back(std::move(blob));
+
+            for (auto* param : processor->getParameters())
+                param->setValueNotifyingHost(random.nextFloat());
+        }
+    }
+
+    std::atomic<bool> running{ true };
+    std::vector<std::thread> threads;
+
+    for (int t = 0; t < options.numAutomationThreads; ++t)
+    {
+        threads.emplace_back([&, t]
+        {
+            juce::Random random(options.randomSeed + 100 + t);
+            auto& params = processor->getParameters();
+
+            while (running.load())
+                params[random.nextInt(params.size())]->setValueNotifyingHost(random.nextFloat());
+        });
+    }
+
+    Histogram histogram;
+
+    std::thread audioThread([&]
+    {
+        juce::Random random(options.randomSeed + 300);
+        juce::AudioBuffer<float> storage(numChannels, options.maxBlockSize);
+        juce::MidiBuffer midi;
+        const int awkwardSizes[] = { 1, 2, 3, 7, 13, 31, 63, 64, 65, 127, 257, 441, 511, 1023 };
+        int rateIndex = 0;
+
+        for (int callback = 0; callback < options.numCallbacks; ++callback)
+        {
+            if (callback > 0 && options.callbacksPerSampleRateChange > 0
+                && callback % options.callbacksPerSampleRateChange == 0)
+            {
+                rateIndex = (rateIndex + 1) % options.sampleRates.size();
+                prepare(options.sampleRates[rateIndex]);
+            }
+
+            const int blockSize = random.nextBool()
+                ? juce::jmin(options.maxBlockSize, awkwardSizes[random.nextInt((int)std::size(awkwardSizes))])
+                : 1 + random.nextInt(options.maxBlockSize);
+
+            // Refers to the storage, so building the view does not allocate.
+            juce::AudioBuffer<float> buffer(storage.getArrayOfWritePointers(), numChannels, blockSize);
+
+            for (int ch = 0; ch < numChannels; ++ch)
+                for (int i = 0; i < blockSize; ++i)
+                    buffer.setSample(ch, i, random.nextFloat() * 2.0f - 1.0f);
+
+            const auto start = juce::Time::getHighResolutionTicks();
+            processor->processBlock(buffer, midi);
+            const auto end = juce::Time::getHighResolutionTicks();
+
+            histogram.add(juce::Time::highResolutionTicksToSeconds(end - start) * 1.0e6);
+        }
+
+        running.store(false);
+    });
+
+    // Editors come and go and saved state is restored on this (the message)
+    // thread while audio runs. Hosts do both from the message thread, and
+    // restoring state from anywhere else would race with the editors here.
+    juce::Random messageThreadRandom(options.randomSeed + 200);
+
+    while (running.load())
+    {
+        if (options.constructEditorsConcurrently)
+        {
+            std::unique_ptr<juce::AudioProcessorEditor> editor(processor->createEditorIfNeeded());
+            editor.reset();
+        }
+
+        if (options.reloadStateConcurrently)
+        {
+            const auto& blob = stateBlobs[(size_t)messageThreadRandom.nextInt((int)stateBlobs.size())];
+            processor->setStateInformation(blob.getData(), (int)blob.getSize());
+        }
+
+        juce::Thread::sleep(1 + messageThreadRandom.nextInt(4));
+    }
+
+    audioThread.join();
+    for (auto& thread : threads)
+        thread.join();
+
+    processor->releaseResources();
+
+    Report report;
+    report.numCallbacks = histogram.getCount();
+    report.p50Microseconds = histogram.getPercentile(50.0);
+    report.p99Microseconds = histogram.getPercentile(99.0);
+    report.p999Microseconds = histogram.getPercentile(99.9);
+    report.maxMicroseconds = histogram.getMax();
+    report.tailMicroseconds = histogram.getPercentile(options.tailPercentile);
+    report.passed = report.tailMicroseconds <= options.deadlineMicroseconds;
+    report.histogram = histogram.toAsciiArt();
+    return report;
+}
+
+#endif
@@ -0,0 +1,79 @@
+/*
+  ==============================================================================
+
+    StressHarness.h
+
+    Worst-case callback timing under adversarial host behaviour. Drives a
+    fresh plugin instance from a dedicated "audio" thread with random block
+    sizes (1, odd and non power of two sizes included), while other threads
+    storm every parameter, the calling (message) thread keeps constructing
+    editors and restoring saved state as a host would, and the sample rate
+    is changed through prepareToPlay. Callback times go into a 1 us histogram; the run fails if
+    the chosen tail percentile exceeds the deadline budget.
+
+    Only compiled with BasicComp_Diagnostics=1. Call run() from the message
+    thread (editors are built there); Diagnostics/BasicCompDiagnostics.jucer
+    builds a console runner for it.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "PluginProcessor.h"
+
+#if BasicComp_Diagnostics
+
+class CallbackStressHarness
+{
+public:
+    struct Options
+    {
+        int numCallbacks{ 200000 };
+        int maxBlockSize{ 2048 };
+        juce::Array<double> sampleRates{ 44100.0, 48000.0, 88200.0, 96000.0, 192000.0 };
+        int callbacksPerSampleRateChange{ 20000 };
+        int numAutomationThreads{ 2 };
+        bool reloadStateConcurrently{ true };
+        bool constructEditorsConcurrently{ true };
+        double tailPercentile{ 99.9 };
+        double deadlineMicroseconds{ 1000.0 };
+        juce::int64 randomSeed{ 1 };
+    };
+
+    struct Report
+    {
+        int numCallbacks{ 0 };
+        double p50Microseconds{ 0.0 };
+        double p99Microseconds{ 0.0 };
+        double p999Microseconds{ 0.0 };
+        double maxMicroseconds{ 0.0 };
+        double tailMicroseconds{ 0.0 };
+        bool passed{ false };
+        juce::String histogram;
+
+        juce::String toString() const;
+    };
+
+    static Report run(const Options& options);
+
+private:
+    /** Linear 1 us buckets up to 100 ms, everything slower lands in the last one. */
+    class Histogram
+    {
+    public:
+        void add(double microseconds) noexcept;
+        double getPercentile(double percentile) const noexcept;
+        double getMax() const noexcept { return maxMicroseconds; }
+        int getCount() const noexcept { return (int)total; }
+        juce::String toAsciiArt() const;
+
+    private:
+        static constexpr int numBuckets = 100000;
+        std::vector<juce::int64> buckets = std::vector<juce::int64>((size_t)numBuckets, 0);
+        juce::int64 total{ 0 };
+        double maxMicroseconds{ 0.0 };
+    };
+};
+
+#endif
@@ -0,0 +1,139 @@
+/*
+  ==============================================================================
+
+    StripRack.cpp
+
+  ==============================================================================
+*/
+
+#include "StripRack.h"
+#include "FastMath.h"
+
+bool StripSettings::operator==(const StripSettings& other) const noexcept
+{
+    return inputDb == other.inputDb && threshDb == other.threshDb && ratio == other.ratio
+        && attackMs == other.attackMs && releaseMs == other.releaseMs
+        && outputDb == other.outputDb && faderDb == other.faderDb;
+}
+
+//==============================================================================
+void StripRack::prepare(double newSampleRate, int newNumStrips)
+{
+    sampleRate = newSampleRate;
+    numStrips = newNumStrips;
+    paddedStrips = (numStrips + laneAlignment - 1) / laneAlignment * laneAlignment;
+
+    fields.calloc((size_t)paddedStrips * numFields);
+
+    // Settings that can never match a real parameter, so the first setStrip() always updates.
+    settings.assign((size_t)numStrips, StripSettings{ -1000.0f, -1000.0f, 0.0f, -1.0f, -1.0f, -1000.0f, -1000.0f });
+
+    // One-pole smoothing that settles within the same 10 ms the classic build's gain ramps take.
+    smoothingCoeff = (float)(1.0 - std::exp(-4.6 / (0.01 * sampleRate)));
+
+    reset();
+}
+
+void StripRack::reset() noexcept
+{
+    juce::FloatVectorOperations::clear(field(envelope), paddedStrips);
+    juce::FloatVectorOperations::clear(field(frame), paddedStrips);
+    snapToTargets = true;
+}
+
+float StripRack::calculateCte(float timeMs) const noexcept
+{
+    // Same time constant as juce::dsp::BallisticsFilter.
+    return timeMs < 1.0e-3f ? 0.0f
+                            : (float)std::exp(-2.0 * juce::MathConstants<double>::pi * 1000.0 / (sampleRate * timeMs));
+}
+
+void StripRack::setStrip(int strip, const StripSettings& newSettings) noexcept
+{
+    jassert(juce::isPositiveAndBelow(strip, numStrips));
+
+    if (!snapToTargets && settings[(size_t)strip] == newSettings)
+        return;
+
+    settings[(size_t)strip] = newSettings;
+
+    const auto threshold = juce::Decibels::decibelsToGain(newSettings.threshDb, -200.0f);
+
+    field(preGainTarget)[strip] = juce::Decibels::decibelsToGain(newSettings.inputDb);
+    field(postGainTarget)[strip] = juce::Decibels::decibelsToGain(newSettings.outputDb + newSettings.faderDb);
+    field(thresholdInverse)[strip] = 1.0f / threshold;
+    field(ratioExponent)[strip] = 1.0f / juce::jmax(1.0f, newSettings.ratio) - 1.0f;
+    field(attackCte)[strip] = calculateCte(newSettings.attackMs);
+    field(releaseCte)[strip] = calculateCte(newSettings.releaseMs);
+
+    if (snapToTargets)
+    {
+        field(preGain)[strip] = field(preGainTarget)[strip];
+        field(postGain)[strip] = field(postGainTarget)[strip];
+    }
+}
+
+void StripRack::process(juce::AudioBuffer<float>& buffer) noexcept
+{
+    snapToTargets = false;
+
+    const int numChannels = juce::jmin(buffer.getNumChannels(), numStrips);
+    const int numSamples = buffer.getNumSamples();
+    auto* const* channels = buffer.getArrayOfWritePointers();
+    auto* x = field(frame);
+
+    for (int n = 0; n < numSamples; ++n)
+    {
+        for (int strip = 0; strip < numChannels; ++strip)
+            x[strip] = channels[strip][n];
+
+        processFrame();
+
+        for (int strip = 0; strip < numChannels; ++strip)
+            channels[strip][n] = x[strip];
+    }
+}
+
+namespace
+{
+    // The fields all live in one allocation, and GCC only trusts __restrict on
+    // parameters, so the kernel takes them as such; with locals it needs more
+    // run-time alias checks than it will emit and leaves the loop scalar.
+    void processStrips(int numStrips, float smoothing,
+                       float* __restrict pre, float* __restrict post, float* __restrict env, float* __restrict x,
+                       const float* __restrict preTarget, const float* __restrict postTarget,
+                       const float* __restrict thrInv, const float* __restrict exponent,
+                       const float* __restrict attack, const float* __restrict release) noexcept
+    {
+        for (int s = 0; s < numStrips; ++s)
+        {
+            pre[s] += (preTarget[s] - pre[s]) * smoothing;
+            post[s] += (postTarget[s] - post[s]) * smoothing;
+
+            const auto in = x[s] * pre[s];
+            const auto level = std::abs(in);
+
+            // Blended rather than selected: GCC turns a select between two loads back into a branch.
+            const auto rising = (float)(level > env[s]);
+            const auto cte = rising * attack[s] + (1.0f - rising) * release[s];
+            env[s] = level + cte * (env[s] - level);
+
+            // pow(env / threshold, 1 / ratio - 1) above the threshold, unity below it.
+            const auto over = env[s] * thrInv[s];
+            const auto gain = FastMath::exp2(exponent[s] * FastMath::log2(over > 1.0f ? over : 1.0f));
+
+            x[s] = in * gain * post[s];
+        }
+    }
+}
+
+void StripRack::processFrame() noexcept
+{
+    // One sample of every strip. Mirrors inputModule -> compressorModule ->
+    // outputModule -> faderModule of the classic build; output and fader are
+    // folded into one gain because nothing nonlinear sits between them.
+    processStrips(paddedStrips, smoothingCoeff,
+                  field(preGain), field(postGain), field(envelope), field(frame),
+                  field(preGainTarget), field(postGainTarget), field(thresholdInverse), field(ratioExponent),
+                  field(attackCte), field(releaseCte));
+}
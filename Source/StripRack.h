@@ -0,0 +1,81 @@
+/*
+  ==============================================================================
+
+    StripRack.h
+
+    Kernel for the multi-strip rack build (see BasicComp_RackStrips): one mono
+    channel strip per bus channel, each with its own input gain, compressor,
+    output gain and fader. Strip state is kept as a structure of arrays padded
+    to a multiple of laneAlignment, so every per-sample update is a single loop
+    across all strips that the compiler turns into SIMD code.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+struct StripSettings
+{
+    float inputDb;
+    float threshDb;
+    float ratio;
+    float attackMs;
+    float releaseMs;
+    float outputDb;
+    float faderDb;
+
+    bool operator==(const StripSettings& other) const noexcept;
+};
+
+//==============================================================================
+class StripRack
+{
+public:
+    /** Parameter ID bases every strip owns; strip n (zero based) uses "<base>_<n + 1>". */
+    static constexpr const char* parameterIds[] = { "input", "thresh", "ratio", "attack", "release", "output", "fader" };
+    static constexpr int numParameters = (int)std::size(parameterIds);
+
+    static juce::String getIdSuffix(int strip) { return "_" + juce::String(strip + 1); }
+
+    //==============================================================================
+    void prepare(double sampleRate, int numStrips);
+    void reset() noexcept;
+
+    /** Audio thread, once per block before process(). Coefficients are only
+        recalculated for strips whose settings actually changed.
+    */
+    void setStrip(int strip, const StripSettings& settings) noexcept;
+
+    /** Channel n of the buffer is strip n. */
+    void process(juce::AudioBuffer<float>& buffer) noexcept;
+
+    int getNumStrips() const noexcept { return numStrips; }
+
+    static constexpr int laneAlignment = 16;
+
+private:
+    enum Field
+    {
+        preGain, preGainTarget, postGain, postGainTarget,
+        thresholdInverse, ratioExponent, attackCte, releaseCte,
+        envelope, frame,
+        numFields
+    };
+
+    float* field(Field f) noexcept { return fields.get() + (size_t)f * (size_t)paddedStrips; }
+    void processFrame() noexcept;
+    float calculateCte(float timeMs) const noexcept;
+
+    juce::HeapBlock<float> fields;
+    std::vector<StripSettings> settings;
+    int numStrips{ 0 };
+    int paddedStrips{ 0 };
+    double sampleRate{ 44100.0 };
+    float smoothingCoeff{ 1.0f };
+    bool snapToTargets{ true };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(StripRack)
+};